@@ -0,0 +1,183 @@
+// batch_env.cpp
+// Vectorized batch environment: steps many headless highway games in lockstep
+// All games live in one Sim::World (shared SoA arrays); work is split across a persistent thread pool
+// See batch_env.h for the C interface and build command
+
+#include "batch_env.h"
+#include "highway_sim.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Vehicle slots per game. A multiple of the SIMD width keeps the per-game traffic span vectorizable
+const int SLOTS_PER_GAME = 16;
+const int OBS_PLAYER_FEATURES = 4;
+const int OBS_VEHICLE_FEATURES = 4;
+const int OBS_DIM = OBS_PLAYER_FEATURES + SLOTS_PER_GAME * OBS_VEHICLE_FEATURES;
+// Games per work item: big enough to amortize scheduling, small enough to balance threads
+const int GAMES_PER_CHUNK = 64;
+
+// Persistent workers that run one parallel-for at a time; the calling thread joins in
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    std::function<void(int)> job;
+    int chunkCount = 0;
+    std::atomic<int> nextChunk{0};
+    int busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+
+    void runChunks() {
+        for (int c = nextChunk.fetch_add(1); c < chunkCount; c = nextChunk.fetch_add(1)) job(c);
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+            }
+            runChunks();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+
+public:
+    explicit WorkerPool(int threadCount) {
+        for (int i = 1; i < threadCount; ++i) threads.emplace_back([this] { workerLoop(); });
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    void parallelFor(int chunks, const std::function<void(int)>& fn) {
+        if (threads.empty() || chunks <= 1) {
+            for (int c = 0; c < chunks; ++c) fn(c);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = fn;
+            chunkCount = chunks;
+            nextChunk.store(0);
+            busyWorkers = (int)threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        runChunks();
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&] { return busyWorkers == 0; });
+    }
+};
+
+} // namespace
+
+struct hw_batch {
+    Sim::World world;
+    WorkerPool pool;
+
+    hw_batch(int numEnvs, uint64_t seed, int numThreads)
+        : world(Sim::Params(), numEnvs, SLOTS_PER_GAME, seed), pool(numThreads) {}
+
+    // Player features then one row per vehicle slot (zero rows for empty slots)
+    void writeObservation(int g, float* out) const {
+        const Sim::Params& p = world.params;
+        const float px = Sim::toFloat(world.playerX[g]), py = Sim::toFloat(world.playerY());
+        out[0] = px / p.roadWidth;
+        out[1] = Sim::toFloat(world.playerSpeed[g]) / p.playerMaxSpeed;
+        out[2] = (float)world.playerTargetLane[g] / (float)std::max(1, p.lanes - 1);
+        out[3] = world.playerChangingLane[g] ? 1.0f : 0.0f;
+
+        float* v = out + OBS_PLAYER_FEATURES;
+        const int begin = world.slotBegin(g), count = world.trafficCount[g];
+        for (int s = 0; s < SLOTS_PER_GAME; ++s, v += OBS_VEHICLE_FEATURES) {
+            if (s < count) {
+                int i = begin + s;
+                v[0] = 1.0f;
+                v[1] = (Sim::toFloat(world.vehX[i]) - px) / p.roadWidth;
+                v[2] = (Sim::toFloat(world.vehY[i]) - py) / p.roadHeight;
+                v[3] = Sim::toFloat(world.vehSpeed[i]) / p.playerMaxSpeed;
+            } else {
+                v[0] = v[1] = v[2] = v[3] = 0.0f;
+            }
+        }
+    }
+
+    int chunkCount() const {
+        return (world.games + GAMES_PER_CHUNK - 1) / GAMES_PER_CHUNK;
+    }
+};
+
+extern "C" {
+
+hw_batch* hw_batch_create(int num_envs, uint64_t seed, int num_threads) {
+    if (num_envs <= 0) return nullptr;
+    if (num_threads <= 0) num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    try {
+        return new hw_batch(num_envs, seed, num_threads);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void hw_batch_destroy(hw_batch* batch) {
+    delete batch;
+}
+
+int hw_batch_num_envs(const hw_batch* batch) {
+    return batch ? batch->world.games : 0;
+}
+
+int hw_batch_obs_dim(void) {
+    return OBS_DIM;
+}
+
+void hw_batch_reset(hw_batch* batch, float* obs) {
+    if (!batch) return;
+    batch->pool.parallelFor(batch->chunkCount(), [&](int chunk) {
+        int begin = chunk * GAMES_PER_CHUNK;
+        int end = std::min(batch->world.games, begin + GAMES_PER_CHUNK);
+        for (int g = begin; g < end; ++g) {
+            batch->world.reset(g);
+            if (obs) batch->writeObservation(g, obs + (size_t)g * OBS_DIM);
+        }
+    });
+}
+
+void hw_batch_step(hw_batch* batch, const int32_t* actions, float* obs, float* rewards, uint8_t* dones) {
+    if (!batch || !actions) return;
+    batch->pool.parallelFor(batch->chunkCount(), [&](int chunk) {
+        Sim::World& world = batch->world;
+        int begin = chunk * GAMES_PER_CHUNK;
+        int end = std::min(world.games, begin + GAMES_PER_CHUNK);
+        for (int g = begin; g < end; ++g) {
+            Sim::StepResult r = world.step(g, (uint32_t)actions[g]);
+            bool done = (r.events & Sim::EVENT_CRASH) != 0;
+            if (done) world.reset(g);
+            if (rewards) rewards[g] = r.reward;
+            if (dones) dones[g] = done ? 1 : 0;
+            if (obs) batch->writeObservation(g, obs + (size_t)g * OBS_DIM);
+        }
+    });
+}
+
+} // extern "C"
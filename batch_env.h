@@ -0,0 +1,59 @@
+/*
+ * batch_env.h
+ * Plain C interface to the vectorized highway environment (batch_env.cpp)
+ *
+ * Steps N independent games in lockstep. Observations are written as a flat
+ * row-major float tensor of shape [num_envs, hw_batch_obs_dim()].
+ * Games that crash are reset automatically: the step that crashes reports
+ * done = 1 and its observation is already the first frame of the next episode.
+ *
+ * Build as a shared library:
+ *   g++ -std=c++17 -O3 -march=native -ffast-math -fPIC -shared batch_env.cpp -o libhwbatch.so -pthread
+ */
+
+#ifndef HW_BATCH_ENV_H
+#define HW_BATCH_ENV_H
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  define HW_BATCH_API __declspec(dllexport)
+#else
+#  define HW_BATCH_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Action bits, same meaning as held keys in the native game; combine with | */
+#define HW_ACTION_ACCELERATE 1
+#define HW_ACTION_BRAKE      2
+#define HW_ACTION_LEFT       4
+#define HW_ACTION_RIGHT      8
+
+typedef struct hw_batch hw_batch;
+
+/* num_threads <= 0 uses every hardware thread. Returns NULL on invalid arguments. */
+HW_BATCH_API hw_batch* hw_batch_create(int num_envs, uint64_t seed, int num_threads);
+HW_BATCH_API void hw_batch_destroy(hw_batch* batch);
+
+HW_BATCH_API int hw_batch_num_envs(const hw_batch* batch);
+HW_BATCH_API int hw_batch_obs_dim(void);
+
+/* Reset every game and write the initial observations */
+HW_BATCH_API void hw_batch_reset(hw_batch* batch, float* obs);
+
+/*
+ * Advance every game by one tick.
+ * actions: [num_envs] action bits; obs: [num_envs * obs_dim];
+ * rewards: [num_envs] score gained; dones: [num_envs] 1 if the episode ended.
+ * rewards and dones may be NULL.
+ */
+HW_BATCH_API void hw_batch_step(hw_batch* batch, const int32_t* actions, float* obs, float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HW_BATCH_ENV_H */
@@ -0,0 +1,160 @@
+// chunk_stream.h
+// Pre-generates one game's upcoming traffic chunks on a JobPool
+// A producer job keeps the next `lookahead` chunks ready in a lock-free queue; at a chunk boundary
+// the sim thread only swaps buffers with a ready chunk, so level-up density jumps cause no hitch
+
+#ifndef CHUNK_STREAM_H
+#define CHUNK_STREAM_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "highway_sim.h"
+#include "job_system.h"
+
+namespace Sim {
+
+class ChunkStream : public ChunkSupplier {
+private:
+    static constexpr int MAX_LOOKAHEAD = 14; // queue capacity minus the empty slot and a spare in flight
+
+    // A chunk plus the epoch it was generated in; chunks from an earlier epoch may have been made
+    // with other params, so take() drops them even when seed and index match
+    struct Slot {
+        TrafficChunk chunk;
+        uint64_t epoch = 0;
+    };
+
+    JobPool& pool;
+    const int lookahead;
+
+    // Chunk objects circulate: producer fills a spare and pushes it to `ready`; the sim swaps its
+    // spent buffer into it and returns it via `spare`. Each queue has one producer and one consumer.
+    std::vector<std::unique_ptr<Slot>> storage;
+    SpscQueue<Slot*, 16> ready, spare;
+
+    // Written by the sim thread, read by the producer
+    std::atomic<uint64_t> seed{0};
+    std::atomic<uint64_t> epoch{0};   // bumped by restart() and retune()
+    std::atomic<int64_t> startIndex{0};
+    std::atomic<int64_t> wanted{-1};  // produce up to this chunk index
+    std::atomic<bool> running{false}; // a producer job is queued or running
+    std::atomic<int> inFlight{0};     // submitted jobs that have not yet let go of `this`
+    std::atomic<bool> stopping{false};
+
+    // Producer state. Only one produce() loop runs at a time, but a finishing job may still read
+    // these while the next one starts, hence atomics
+    std::atomic<uint64_t> producerEpoch{~0ull};
+    std::atomic<int64_t> nextIndex{0};
+    uint64_t producerSeed = 0;
+    Params params;
+
+    // retune() hands new params over here; the producer copies them when it sees the new epoch
+    std::mutex pendingLock;
+    Params pendingParams;
+
+    bool hasWork() const {
+        return !stopping.load() && !spare.empty() && (epoch.load() != producerEpoch || nextIndex <= wanted.load());
+    }
+
+    void produce() {
+        for (;;) {
+            while (!stopping.load()) {
+                uint64_t e = epoch.load();
+                if (e != producerEpoch.load()) {
+                    producerEpoch.store(e);
+                    producerSeed = seed.load();
+                    {
+                        std::lock_guard<std::mutex> lock(pendingLock);
+                        params = pendingParams;
+                    }
+                    nextIndex.store(startIndex.load());
+                }
+                int64_t index = nextIndex.load();
+                if (index > wanted.load()) break;
+                Slot* slot;
+                if (!spare.pop(slot)) break;
+                generateTrafficChunk(params, producerSeed, index, slot->chunk);
+                slot->epoch = e;
+                nextIndex.store(index + 1);
+                ready.push(slot); // can't fail: ready holds at most storage.size() - 1 chunks
+            }
+            running.store(false);
+            // Work that arrived after the last check must not be stranded
+            if (!hasWork() || running.exchange(true)) return;
+        }
+    }
+
+    // Clearing `running` doesn't end a job: it still reads members afterwards. Dropping inFlight is
+    // each job's last touch of the stream, so the destructor waits on that instead.
+    void kick() {
+        if (running.exchange(true)) return;
+        inFlight.fetch_add(1, std::memory_order_relaxed);
+        pool.submit([this] {
+            produce();
+            inFlight.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    // Seed and start index are stored before the epoch bump that makes the producer read them
+    void begin(uint64_t newSeed, int64_t fromIndex) {
+        seed.store(newSeed);
+        startIndex.store(fromIndex);
+        wanted.store(fromIndex + lookahead);
+        epoch.fetch_add(1);
+        kick();
+    }
+
+public:
+    ChunkStream(JobPool& jobPool, const Params& p, int chunksAhead)
+        : pool(jobPool), lookahead(std::max(1, std::min(MAX_LOOKAHEAD, chunksAhead))), params(p), pendingParams(p) {
+        for (int i = 0; i < lookahead + 1; ++i) {
+            storage.emplace_back(new Slot());
+            spare.push(storage.back().get());
+        }
+    }
+
+    ~ChunkStream() {
+        stopping.store(true);
+        while (inFlight.load(std::memory_order_acquire) > 0) std::this_thread::yield();
+    }
+
+    void restart(uint64_t newSeed) override {
+        begin(newSeed, 0);
+    }
+
+    void retune(const Params& p, uint64_t newSeed, int64_t fromIndex) override {
+        {
+            std::lock_guard<std::mutex> lock(pendingLock);
+            pendingParams = p;
+        }
+        begin(newSeed, fromIndex);
+    }
+
+    // Chunks come out in index order per epoch, so anything older than the request is stale
+    bool take(uint64_t forSeed, int64_t index, TrafficChunk& into) override {
+        const uint64_t current = epoch.load(); // only this thread bumps it
+        Slot* slot;
+        bool found = false;
+        while (ready.peek(slot)) {
+            const bool live = slot->epoch == current && slot->chunk.seed == forSeed;
+            if (live && slot->chunk.index > index) break;
+            ready.pop(slot);
+            if (live && slot->chunk.index == index) {
+                std::swap(slot->chunk, into);
+                found = true;
+            }
+            spare.push(slot);
+            if (found) break;
+        }
+        wanted.store(index + lookahead);
+        kick();
+        return found;
+    }
+};
+
+} // namespace Sim
+
+#endif // CHUNK_STREAM_H
@@ -0,0 +1,108 @@
+// ecs.h
+// Minimal archetype storage for entity-component-system code
+// An Archetype holds every entity with one fixed set of components, one contiguous column per
+// component; systems are plain functions over column spans. No SFML dependency.
+
+#ifndef ECS_H
+#define ECS_H
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace Ecs {
+
+// Entities are rows; rows stay dense (destroy swaps the last row in), so a row index is only
+// valid until the next destroy. Systems should not hold on to it.
+template <typename... Components>
+class Archetype {
+private:
+    std::tuple<std::vector<Components>...> columns;
+    size_t count = 0;
+
+    template <size_t... I>
+    void pushRow(std::index_sequence<I...>, const Components&... values) {
+        int expand[] = { (std::get<I>(columns).push_back(values), 0)... };
+        (void)expand;
+    }
+
+    template <size_t... I>
+    void moveRow(std::index_sequence<I...>, size_t to, size_t from) {
+        int expand[] = { (std::get<I>(columns)[to] = std::move(std::get<I>(columns)[from]), 0)... };
+        (void)expand;
+    }
+
+    template <size_t... I>
+    void popRow(std::index_sequence<I...>) {
+        int expand[] = { (std::get<I>(columns).pop_back(), 0)... };
+        (void)expand;
+    }
+
+    template <size_t... I>
+    void clearRows(std::index_sequence<I...>) {
+        int expand[] = { (std::get<I>(columns).clear(), 0)... };
+        (void)expand;
+    }
+
+    template <size_t... I>
+    void reserveRows(std::index_sequence<I...>, size_t rows) {
+        int expand[] = { (std::get<I>(columns).reserve(rows), 0)... };
+        (void)expand;
+    }
+
+public:
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void reserve(size_t rows) {
+        reserveRows(std::index_sequence_for<Components...>(), rows);
+    }
+
+    size_t create(const Components&... values) {
+        pushRow(std::index_sequence_for<Components...>(), values...);
+        return count++;
+    }
+
+    void destroy(size_t row) {
+        if (row + 1 != count) moveRow(std::index_sequence_for<Components...>(), row, count - 1);
+        popRow(std::index_sequence_for<Components...>());
+        count--;
+    }
+
+    // One clear() per column, so constant time for trivially destructible components; capacity stays
+    void clear() {
+        clearRows(std::index_sequence_for<Components...>());
+        count = 0;
+    }
+
+    template <typename C>
+    C* column() { return std::get<std::vector<C>>(columns).data(); }
+
+    template <typename C>
+    const C* column() const { return std::get<std::vector<C>>(columns).data(); }
+
+    // Run a system over the named component columns: system(count, C1*, C2*, ...)
+    template <typename... Cs, typename System>
+    void run(System system) {
+        system(count, column<Cs>()...);
+    }
+
+    template <typename... Cs, typename System>
+    void run(System system) const {
+        system(count, column<Cs>()...);
+    }
+
+    // Destroy every row for which dead(row) is true; one pass, order not preserved
+    template <typename Predicate>
+    void destroyIf(Predicate dead) {
+        for (size_t row = 0; row < count;) {
+            if (dead(row)) destroy(row);
+            else ++row;
+        }
+    }
+};
+
+} // namespace Ecs
+
+#endif // ECS_H
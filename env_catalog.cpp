@@ -0,0 +1,111 @@
+// env_catalog.cpp - compile environments.json into a binary catalog and query it (env_catalog.h)
+//   env_catalog compile [in.json] [out.hwenv]   defaults: environments.json -> environments.hwenv
+//   env_catalog lookup <catalog> <id>...        print environments by id
+//   env_catalog --bench [count]                 open and lookup cost for `count` environments
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "env_catalog.h"
+
+static void print(const Sim::EnvConfig& e) {
+    std::cout << e.id << ": \"" << e.name << "\" seed=" << e.seed << " friction=" << e.friction
+              << " speedMul=" << e.speedMultiplier << " obstacles=" << e.obstacleDensity
+              << " powerups=" << e.powerupDensity << " rain=" << e.weather.probRain
+              << " fog=" << e.weather.probFog << " bg=" << e.visual.bgType << "\n";
+}
+
+static int compile(const std::string& in, const std::string& out) {
+    std::vector<Sim::EnvConfig> envs;
+    std::string message;
+    if (!Sim::loadEnvironments(in, envs, message) || !Sim::writeEnvCatalog(envs, out, message)) {
+        std::cerr << "Error: " << message << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << envs.size() << " environments to " << out << std::endl;
+    return 0;
+}
+
+static int lookup(const std::string& path, int count, char** ids) {
+    Sim::EnvCatalog catalog;
+    std::string message;
+    if (!catalog.open(path, message)) {
+        std::cerr << "Error: " << message << std::endl;
+        return 1;
+    }
+    int missing = 0;
+    Sim::EnvConfig env;
+    for (int i = 0; i < count; ++i) {
+        if (catalog.get(ids[i], env)) {
+            print(env);
+        } else {
+            std::cout << ids[i] << ": not found\n";
+            missing++;
+        }
+    }
+    return missing ? 1 : 0;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int bench(int count) {
+    std::vector<Sim::EnvConfig> envs(count);
+    static const char* const BG_TYPES[] = { "city", "mountain", "jungle" };
+    for (int i = 0; i < count; ++i) {
+        Sim::EnvConfig& e = envs[i];
+        e.id = "env_" + std::to_string(i);
+        e.name = "Environment " + std::to_string(i);
+        e.seed = i * 7919;
+        e.friction = 1.0f + (i % 25) * 0.01f;
+        e.visual.bgType = BG_TYPES[i % 3];
+    }
+    const std::string path = "env_bench.hwenv";
+    std::string message;
+    auto start = std::chrono::steady_clock::now();
+    if (!Sim::writeEnvCatalog(envs, path, message)) {
+        std::cerr << "Error: " << message << std::endl;
+        return 1;
+    }
+    std::printf("%d environments compiled in %.1f ms\n", count, secondsSince(start) * 1e3);
+
+    const int OPENS = 1000;
+    Sim::EnvCatalog catalog;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < OPENS; ++i) catalog.open(path, message);
+    std::printf("open:   %.2f us\n", secondsSince(start) / OPENS * 1e6);
+
+    const int LOOKUPS = 2000000;
+    std::vector<std::string> keys(4096);
+    for (size_t k = 0; k < keys.size(); ++k) keys[k] = "env_" + std::to_string((k * 2654435761u) % (uint32_t)count);
+    double checksum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LOOKUPS; ++i) {
+        const Sim::CatalogRecord* r = catalog.find(keys[i & 4095]);
+        if (r) checksum += r->friction;
+    }
+    std::printf("lookup: %.1f ns (checksum %.0f)\n", secondsSince(start) / LOOKUPS * 1e9, checksum);
+    catalog.close();
+    std::remove(path.c_str());
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string command = argc >= 2 ? argv[1] : "";
+    if (command == "compile") {
+        return compile(argc >= 3 ? argv[2] : "environments.json", argc >= 4 ? argv[3] : "environments.hwenv");
+    }
+    if (command == "lookup" && argc >= 4) {
+        return lookup(argv[2], argc - 3, argv + 3);
+    }
+    if (command == "--bench") {
+        return bench(argc >= 3 ? std::max(1, std::atoi(argv[2])) : 100000);
+    }
+    std::cerr << "Usage: " << argv[0] << " compile [in.json] [out.hwenv] | lookup <catalog> <id>... | --bench [count]"
+              << std::endl;
+    return 1;
+}
@@ -0,0 +1,305 @@
+// env_catalog.h
+// Binary environment catalogs: compiled once from environments.json, then memory-mapped
+// Fixed-size records, one interned string table and an open-addressing hash index on id, so
+// opening a catalog only checks its header and a lookup touches a few cache lines whatever the
+// catalog size. No SFML dependency.
+
+#ifndef ENV_CATALOG_H
+#define ENV_CATALOG_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "env_config.h"
+#include "state_hash.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Sim {
+
+const uint32_t CATALOG_MAGIC = 0x43455748u; // "HWEC"
+const uint32_t CATALOG_VERSION = 1;
+
+// File layout (little-endian): header, records, index buckets, string bytes. Offsets are from
+// the start of the file; every section is 8-byte aligned.
+struct CatalogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;       // records
+    uint32_t bucketCount; // power of two, at least twice count
+    uint64_t recordsOffset;
+    uint64_t bucketsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringBytes;
+};
+
+// A string is (offset, length) into the string table; equal strings share one copy
+struct CatalogString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct CatalogRecord {
+    uint64_t idHash; // XXH64 of the id, checked before comparing the id itself
+    CatalogString id, name, bgType;
+    int32_t seed;
+    float friction, speedMultiplier;
+    float obstacleDensity, powerupDensity;
+    float probRain, probFog;
+    uint32_t skyColor;
+    uint8_t laneRumble;
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(CatalogHeader) == 48, "catalog header layout");
+static_assert(sizeof(CatalogRecord) == 72, "catalog record layout");
+
+inline uint64_t catalogHash(std::string_view id) {
+    return XXH64::hash(id.data(), id.size(), CATALOG_MAGIC);
+}
+
+// Compile `envs` into a catalog at `path`. Ids must be unique
+inline bool writeEnvCatalog(const std::vector<EnvConfig>& envs, const std::string& path, std::string& message) {
+    std::string strings;
+    std::unordered_map<std::string, CatalogString> interned;
+    auto intern = [&](const std::string& s) {
+        auto found = interned.find(s);
+        if (found != interned.end()) return found->second;
+        CatalogString ref = { (uint32_t)strings.size(), (uint32_t)s.size() };
+        strings += s;
+        interned.emplace(s, ref);
+        return ref;
+    };
+
+    CatalogHeader header = {};
+    header.magic = CATALOG_MAGIC;
+    header.version = CATALOG_VERSION;
+    header.count = (uint32_t)envs.size();
+    header.bucketCount = 2;
+    while (header.bucketCount < 2 * header.count) header.bucketCount *= 2;
+
+    // Buckets hold record index + 1 (0 is empty); linear probing
+    std::vector<CatalogRecord> records(envs.size());
+    std::vector<uint32_t> buckets(header.bucketCount, 0);
+    const uint32_t mask = header.bucketCount - 1;
+    for (size_t i = 0; i < envs.size(); ++i) {
+        const EnvConfig& env = envs[i];
+        CatalogRecord& r = records[i];
+        std::memset(&r, 0, sizeof(r));
+        r.idHash = catalogHash(env.id);
+        uint32_t b = (uint32_t)r.idHash & mask;
+        for (; buckets[b]; b = (b + 1) & mask) {
+            const CatalogRecord& other = records[buckets[b] - 1];
+            if (other.idHash == r.idHash && envs[buckets[b] - 1].id == env.id) {
+                message = "duplicate environment id " + env.id;
+                return false;
+            }
+        }
+        buckets[b] = (uint32_t)i + 1;
+        r.id = intern(env.id);
+        r.name = intern(env.name);
+        r.bgType = intern(env.visual.bgType);
+        r.seed = env.seed;
+        r.friction = env.friction;
+        r.speedMultiplier = env.speedMultiplier;
+        r.obstacleDensity = env.obstacleDensity;
+        r.powerupDensity = env.powerupDensity;
+        r.probRain = env.weather.probRain;
+        r.probFog = env.weather.probFog;
+        r.skyColor = env.visual.skyColor;
+        r.laneRumble = env.laneRumble ? 1 : 0;
+    }
+    if (strings.size() > 0xffffffffull) {
+        message = "string table over 4 GB";
+        return false;
+    }
+
+    auto align8 = [](uint64_t n) { return (n + 7) & ~7ull; };
+    header.recordsOffset = sizeof(CatalogHeader);
+    header.bucketsOffset = align8(header.recordsOffset + records.size() * sizeof(CatalogRecord));
+    header.stringsOffset = align8(header.bucketsOffset + buckets.size() * sizeof(uint32_t));
+    header.stringBytes = strings.size();
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        message = "cannot write " + path;
+        return false;
+    }
+    static const char zeros[8] = {};
+    const size_t bucketPad = (size_t)(header.stringsOffset - header.bucketsOffset - buckets.size() * sizeof(uint32_t));
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1
+        && std::fwrite(records.data(), sizeof(CatalogRecord), records.size(), f) == records.size()
+        && std::fwrite(buckets.data(), sizeof(uint32_t), buckets.size(), f) == buckets.size()
+        && std::fwrite(zeros, 1, bucketPad, f) == bucketPad
+        && std::fwrite(strings.data(), 1, strings.size(), f) == strings.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) message = "error writing " + path;
+    return ok;
+}
+
+// Read-only view of a compiled catalog. open() maps the file and checks the header and section
+// bounds; records are only touched when looked up, so opening costs the same for any size.
+class EnvCatalog {
+private:
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+    const CatalogHeader* header = nullptr;
+    const CatalogRecord* records = nullptr;
+    const uint32_t* buckets = nullptr;
+    const char* strings = nullptr;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    bool map(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) return false;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return false;
+        data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        length = (size_t)size.QuadPart;
+        return data != nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return false;
+        data = (const unsigned char*)mapped;
+        length = (size_t)st.st_size;
+        return true;
+#endif
+    }
+
+public:
+    EnvCatalog() {}
+    ~EnvCatalog() { close(); }
+
+    EnvCatalog(const EnvCatalog&) = delete;
+    EnvCatalog& operator=(const EnvCatalog&) = delete;
+
+    bool open(const std::string& path, std::string& message) {
+        close();
+        if (!map(path)) {
+            close();
+            message = "cannot map " + path;
+            return false;
+        }
+        header = (const CatalogHeader*)data;
+        const char* invalid = nullptr;
+        if (length < sizeof(CatalogHeader) || header->magic != CATALOG_MAGIC) invalid = "not an environment catalog";
+        else if (header->version != CATALOG_VERSION) invalid = "unsupported catalog version";
+        else if (header->bucketCount == 0 || (header->bucketCount & (header->bucketCount - 1))
+                 || header->bucketCount < header->count) invalid = "bad index size";
+        else if (header->recordsOffset % 8 || header->bucketsOffset % 8 || header->recordsOffset < sizeof(CatalogHeader)
+                 || header->recordsOffset > header->bucketsOffset || header->bucketsOffset > header->stringsOffset
+                 || header->stringsOffset > length) invalid = "truncated catalog";
+        // Sections are checked by subtraction from offsets already known to be in order and in
+        // the file, so a crafted header cannot wrap the sums past the end
+        else if ((uint64_t)header->count * sizeof(CatalogRecord) > header->bucketsOffset - header->recordsOffset
+                 || (uint64_t)header->bucketCount * sizeof(uint32_t) > header->stringsOffset - header->bucketsOffset
+                 || header->stringBytes > length - header->stringsOffset) invalid = "truncated catalog";
+        if (invalid) {
+            close();
+            message = path + ": " + invalid;
+            return false;
+        }
+        records = (const CatalogRecord*)(data + header->recordsOffset);
+        buckets = (const uint32_t*)(data + header->bucketsOffset);
+        strings = (const char*)(data + header->stringsOffset);
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap((void*)data, length);
+#endif
+        data = nullptr;
+        length = 0;
+        header = nullptr;
+        records = nullptr;
+        buckets = nullptr;
+        strings = nullptr;
+    }
+
+    bool isOpen() const { return data != nullptr; }
+    uint32_t size() const { return header ? header->count : 0; }
+    const CatalogRecord& record(uint32_t index) const { return records[index]; }
+
+    // Empty for a reference outside the string table (a damaged file)
+    std::string_view text(CatalogString s) const {
+        if ((uint64_t)s.offset + s.length > header->stringBytes) return std::string_view();
+        return std::string_view(strings + s.offset, s.length);
+    }
+
+    // The record with this id, or null
+    const CatalogRecord* find(std::string_view id) const {
+        if (!header || header->count == 0) return nullptr;
+        const uint64_t hash = catalogHash(id);
+        const uint32_t mask = header->bucketCount - 1;
+        for (uint32_t b = (uint32_t)hash & mask, probes = 0; probes <= mask; b = (b + 1) & mask, ++probes) {
+            const uint32_t slot = buckets[b];
+            if (slot == 0 || slot > header->count) return nullptr;
+            const CatalogRecord& r = records[slot - 1];
+            if (r.idHash == hash && text(r.id) == id) return &r;
+        }
+        return nullptr;
+    }
+
+    // Copy a record out as an EnvConfig
+    void get(const CatalogRecord& r, EnvConfig& env) const {
+        std::string_view id = text(r.id), name = text(r.name), bgType = text(r.bgType);
+        env.id.assign(id.data(), id.size());
+        env.name.assign(name.data(), name.size());
+        env.visual.bgType.assign(bgType.data(), bgType.size());
+        env.seed = r.seed;
+        env.friction = r.friction;
+        env.speedMultiplier = r.speedMultiplier;
+        env.obstacleDensity = r.obstacleDensity;
+        env.powerupDensity = r.powerupDensity;
+        env.laneRumble = r.laneRumble != 0;
+        env.weather.probRain = r.probRain;
+        env.weather.probFog = r.probFog;
+        env.visual.skyColor = r.skyColor;
+    }
+
+    bool get(std::string_view id, EnvConfig& env) const {
+        const CatalogRecord* r = find(id);
+        if (!r) return false;
+        get(*r, env);
+        return true;
+    }
+};
+
+} // namespace Sim
+
+#endif // ENV_CATALOG_H
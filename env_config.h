@@ -0,0 +1,157 @@
+// env_config.h
+// Driving environments (environments.json): surface physics, item densities, weather and look
+// A schema-specific walk over Json::Reader fills each environment object straight into one reused
+// EnvConfig, so loading builds no document tree. No SFML dependency.
+
+#ifndef ENV_CONFIG_H
+#define ENV_CONFIG_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "json_reader.h"
+
+namespace Sim {
+
+// Missing keys keep these defaults
+struct EnvConfig {
+    struct Weather {
+        float probRain = 0.0f;
+        float probFog = 0.0f;
+    };
+    struct Visual {
+        uint32_t skyColor = 0x000000ff; // RGBA
+        std::string bgType;
+    };
+
+    std::string id;
+    std::string name;
+    int seed = 0;
+    float friction = 1.0f;
+    float speedMultiplier = 1.0f;
+    float obstacleDensity = 0.04f;
+    float powerupDensity = 0.02f;
+    bool laneRumble = false;
+    Weather weather;
+    Visual visual;
+};
+
+// One environment object into `env`. Every field is reset first, but the strings keep their
+// buffers, so reading many environments into the same EnvConfig stops allocating early on
+inline void readEnvConfig(Json::Reader& r, EnvConfig& env) {
+    std::string_view key, section, text;
+    env.id.clear();
+    env.name.clear();
+    env.visual.bgType.clear();
+    env.seed = 0;
+    env.friction = 1.0f;
+    env.speedMultiplier = 1.0f;
+    env.obstacleDensity = 0.04f;
+    env.powerupDensity = 0.02f;
+    env.laneRumble = false;
+    env.weather = EnvConfig::Weather();
+    env.visual.skyColor = 0x000000ff;
+
+    r.beginObject();
+    while (r.nextMember(key)) {
+        if (key == "id") r.readString(env.id);
+        else if (key == "name") r.readString(env.name);
+        else if (key == "seed") r.readNumber(env.seed);
+        else if (key == "friction") r.readNumber(env.friction);
+        else if (key == "speedMultiplier") r.readNumber(env.speedMultiplier);
+        else if (key == "obstacleDensity") r.readNumber(env.obstacleDensity);
+        else if (key == "powerupDensity") r.readNumber(env.powerupDensity);
+        else if (key == "laneRumble") r.readBool(env.laneRumble);
+        else if (key == "weather") {
+            r.beginObject();
+            while (r.nextMember(section)) {
+                if (section == "probRain") r.readNumber(env.weather.probRain);
+                else if (section == "probFog") r.readNumber(env.weather.probFog);
+                else r.skipValue();
+            }
+        } else if (key == "visual") {
+            r.beginObject();
+            while (r.nextMember(section)) {
+                if (section == "skyColor") {
+                    if (r.readString(text) && !Json::parseHexColor(text, env.visual.skyColor)) {
+                        r.reject("expected a #rrggbb color");
+                    }
+                } else if (section == "bgType") {
+                    r.readString(env.visual.bgType);
+                } else {
+                    r.skipValue();
+                }
+            }
+        } else {
+            r.skipValue();
+        }
+    }
+}
+
+// First problem that would break the sim, or an empty string
+inline std::string validateEnvConfig(const EnvConfig& env) {
+    if (env.id.empty()) return "id must not be empty";
+    if (!(env.friction > 0) || !(env.speedMultiplier > 0)) return "friction and speedMultiplier must be positive";
+    if (!(env.obstacleDensity >= 0 && env.powerupDensity >= 0 && env.obstacleDensity + env.powerupDensity <= 1)) {
+        return "obstacleDensity and powerupDensity must be non-negative and sum to at most 1";
+    }
+    if (!(env.weather.probRain >= 0 && env.weather.probRain <= 1 && env.weather.probFog >= 0 && env.weather.probFog <= 1)) {
+        return "weather probabilities must be 0..1";
+    }
+    return std::string();
+}
+
+// Call visit(const EnvConfig&) for each environment of the top-level array, in file order. The
+// EnvConfig is reused, so visit copies what it keeps. Stops at the first syntax or schema error
+// and says where in `message`
+template <typename Visit>
+bool readEnvironments(Json::Reader& r, std::string& message, Visit visit) {
+    EnvConfig env;
+    int index = 0;
+    r.beginArray();
+    while (r.nextElement()) {
+        readEnvConfig(r, env);
+        if (!r.ok()) break;
+        std::string invalid = validateEnvConfig(env);
+        if (!invalid.empty()) {
+            message = "environment " + std::to_string(index) + " (" + env.id + "): " + invalid;
+            return false;
+        }
+        visit(env);
+        index++;
+    }
+    if (r.ok() && !r.atEnd()) r.reject("unexpected text after the environments array");
+    if (!r.ok()) {
+        message = "line " + std::to_string(r.errorLine()) + ": " + r.errorMessage();
+        return false;
+    }
+    return true;
+}
+
+// Parse a whole environments document into `envs`. On failure `envs` is left untouched
+inline bool parseEnvironments(std::string_view text, std::vector<EnvConfig>& envs, std::string& message) {
+    std::vector<EnvConfig> loaded;
+    Json::Reader reader(text);
+    if (!readEnvironments(reader, message, [&](const EnvConfig& env) { loaded.push_back(env); })) return false;
+    envs.swap(loaded);
+    return true;
+}
+
+inline bool loadEnvironments(const std::string& path, std::vector<EnvConfig>& envs, std::string& message) {
+    message.clear();
+    std::string text;
+    if (!Json::readFile(path, text)) {
+        message = "cannot open " + path;
+        return false;
+    }
+    if (!parseEnvironments(text, envs, message)) {
+        message = path + ": " + message;
+        return false;
+    }
+    return true;
+}
+
+} // namespace Sim
+
+#endif // ENV_CONFIG_H
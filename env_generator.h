@@ -0,0 +1,278 @@
+// env_generator.h
+// Procedural environments from a 64-bit seed, and the tables derived from an environment
+// generateEnvConfig() expands a seed into a full EnvConfig in a few hundred nanoseconds, so any
+// number of environments exist without a file. The per-environment spawn tables and weather
+// schedule cost far more to build and are memoized in a small LRU cache. No SFML dependency.
+
+#ifndef ENV_GENERATOR_H
+#define ENV_GENERATOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "env_catalog.h"
+#include "env_config.h"
+#include "highway_sim.h"
+#include "state_hash.h"
+
+namespace Sim {
+
+// Procedural ids are "proc_" + the seed in 16 hex digits, so an id alone names its environment
+inline std::string proceduralEnvId(uint64_t seed) {
+    char id[24];
+    std::snprintf(id, sizeof(id), "proc_%016llx", (unsigned long long)seed);
+    return id;
+}
+
+inline bool parseProceduralEnvId(std::string_view id, uint64_t& seed) {
+    if (id.size() != 21 || id.substr(0, 5) != "proc_") return false;
+    uint64_t value = 0;
+    for (size_t i = 5; i < id.size(); ++i) {
+        char c = id[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= (uint64_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= (uint64_t)(c - 'a' + 10);
+        else return false;
+    }
+    seed = value;
+    return true;
+}
+
+// Backgrounds the renderers know, with the traffic mix each favors (indexed like VEHICLE_SPECS:
+// compact, sedan, SUV, sports, truck) and the range its sky color is drawn from
+struct BackgroundStyle {
+    const char* bgType;
+    float typeBias[VEHICLE_TYPE_COUNT];
+    uint8_t skyLow[3], skyHigh[3];
+};
+
+const int BACKGROUND_STYLE_COUNT = 5;
+const BackgroundStyle BACKGROUND_STYLES[BACKGROUND_STYLE_COUNT] = {
+    { "city",     { 1.3f, 1.2f, 0.8f, 1.0f, 0.6f }, { 5, 10, 25 },    { 40, 50, 80 } },
+    { "mountain", { 0.8f, 0.9f, 1.3f, 0.7f, 1.6f }, { 40, 55, 70 },   { 110, 130, 150 } },
+    { "jungle",   { 0.9f, 0.9f, 1.4f, 0.8f, 1.0f }, { 15, 60, 15 },   { 50, 110, 60 } },
+    { "desert",   { 0.8f, 1.0f, 1.0f, 1.4f, 1.2f }, { 180, 140, 90 }, { 240, 200, 140 } },
+    { "coast",    { 1.0f, 1.2f, 0.9f, 1.3f, 0.7f }, { 90, 150, 200 }, { 150, 200, 240 } }
+};
+
+inline const BackgroundStyle* findBackgroundStyle(std::string_view bgType) {
+    for (int i = 0; i < BACKGROUND_STYLE_COUNT; ++i) {
+        if (bgType == BACKGROUND_STYLES[i].bgType) return &BACKGROUND_STYLES[i];
+    }
+    return nullptr;
+}
+
+// Ranges cover the hand-written environments with some room either side
+inline EnvConfig generateEnvConfig(uint64_t seed) {
+    static const char* const MOODS[] = { "Misty", "Golden", "Midnight", "Rolling", "Windy", "Quiet", "Neon", "Stormy" };
+    static const char* const PLACES[] = { "Boulevard", "Pass", "Canopy", "Dunes", "Causeway", "Ridge", "Bay", "Loop" };
+    Rng rng(seed);
+    EnvConfig env;
+    env.id = proceduralEnvId(seed);
+    env.seed = (int)(rng.next() >> 33);
+    const BackgroundStyle& style = BACKGROUND_STYLES[rng.next() % BACKGROUND_STYLE_COUNT];
+    env.name = std::string(MOODS[rng.next() % 8]) + " " + PLACES[rng.next() % 8];
+    env.friction = rng.range(0.95f, 1.25f);
+    env.speedMultiplier = rng.range(0.85f, 1.05f);
+    env.obstacleDensity = rng.range(0.02f, 0.09f);
+    env.powerupDensity = rng.range(0.005f, 0.03f);
+    env.laneRumble = (rng.next() & 1) != 0;
+    env.weather.probRain = rng.range(0.0f, 0.7f);
+    env.weather.probFog = rng.range(0.0f, 0.35f);
+    uint32_t sky = 0;
+    for (int c = 0; c < 3; ++c) {
+        sky = (sky << 8) | (uint32_t)rng.range(style.skyLow[c], style.skyHigh[c] + 0.99f);
+    }
+    env.visual.skyColor = (sky << 8) | 0xff;
+    env.visual.bgType = style.bgType;
+    return env;
+}
+
+// Weather comes in spells of one kind; the schedule is a fixed cycle of spells that repeats
+enum WeatherKind : uint8_t {
+    WEATHER_CLEAR = 0,
+    WEATHER_RAIN,
+    WEATHER_FOG
+};
+
+struct WeatherSpell {
+    uint32_t startTick; // from the start of the cycle
+    uint32_t ticks;
+    uint8_t kind;
+    float intensity;    // 0..1 for rain and fog
+};
+
+const int WEATHER_SCHEDULE_SPELLS = 32;
+const uint32_t WEATHER_MIN_SPELL_TICKS = 20 * 60;
+const uint32_t WEATHER_MAX_SPELL_TICKS = 60 * 60;
+
+// Traffic mix from the background plus up to ±15% per type from the environment's seed
+inline void envTrafficMix(const EnvConfig& env, float mix[VEHICLE_TYPE_COUNT]) {
+    Rng rng((uint64_t)(uint32_t)env.seed ^ 0x74726166666963ull);
+    const BackgroundStyle* style = findBackgroundStyle(env.visual.bgType);
+    for (int t = 0; t < VEHICLE_TYPE_COUNT; ++t) {
+        mix[t] = (style ? style->typeBias[t] : 1.0f) * rng.range(0.85f, 1.15f);
+    }
+}
+
+// Fold an environment into sim params: item densities, surface physics and traffic mix
+inline void applyEnvironment(const EnvConfig& env, Params& p) {
+    p.obstacleDensity = env.obstacleDensity;
+    p.powerupDensity = env.powerupDensity;
+    p.friction = env.friction;
+    p.speedMultiplier = env.speedMultiplier;
+    envTrafficMix(env, p.trafficMix);
+}
+
+// Environment `id`: a procedural id is generated, anything else is looked up in the
+// environments file at `path`. A .hwenv catalog is mapped and probed by id, so startup doesn't
+// grow with the catalog; any other file is parsed as environments JSON.
+inline bool findEnvironment(const std::string& id, const std::string& path, EnvConfig& env, std::string& message) {
+    uint64_t seed;
+    if (parseProceduralEnvId(id, seed)) {
+        env = generateEnvConfig(seed);
+        return true;
+    }
+    const std::string catalogExtension = ".hwenv";
+    if (path.size() >= catalogExtension.size()
+        && path.compare(path.size() - catalogExtension.size(), catalogExtension.size(), catalogExtension) == 0) {
+        EnvCatalog catalog;
+        if (!catalog.open(path, message)) return false;
+        if (catalog.get(id, env)) return true;
+        message = path + ": no environment \"" + id + "\"";
+        return false;
+    }
+    std::vector<EnvConfig> envs;
+    if (!loadEnvironments(path, envs, message)) return false;
+    for (size_t i = 0; i < envs.size(); ++i) {
+        if (envs[i].id == id) {
+            env = envs[i];
+            return true;
+        }
+    }
+    message = path + ": no environment \"" + id + "\"";
+    return false;
+}
+
+// Everything derived from an environment that is too costly to rebuild per episode
+struct EnvTables {
+    std::shared_ptr<const SpawnTables> spawn; // for applyEnvironment's trafficMix
+    WeatherSpell weather[WEATHER_SCHEDULE_SPELLS];
+    uint32_t weatherCycleTicks;
+
+    // The spell covering `tick` (ticks since the episode started)
+    const WeatherSpell& weatherAt(uint64_t tick) const {
+        const uint32_t t = (uint32_t)(tick % weatherCycleTicks);
+        int lo = 0, hi = WEATHER_SCHEDULE_SPELLS - 1;
+        while (lo < hi) {
+            int mid = (lo + hi + 1) / 2;
+            if (weather[mid].startTick <= t) lo = mid;
+            else hi = mid - 1;
+        }
+        return weather[lo];
+    }
+};
+
+// Each spell is rain with probRain, else fog with probFog, else clear
+inline std::shared_ptr<const EnvTables> buildEnvTables(const EnvConfig& env) {
+    Rng rng((uint64_t)(uint32_t)env.seed ^ 0x77656174686572ull);
+    float mix[VEHICLE_TYPE_COUNT];
+    envTrafficMix(env, mix);
+    std::shared_ptr<EnvTables> tables = std::make_shared<EnvTables>();
+    tables->spawn = SpawnTables::forMix(mix);
+    uint32_t start = 0;
+    for (int i = 0; i < WEATHER_SCHEDULE_SPELLS; ++i) {
+        WeatherSpell& spell = tables->weather[i];
+        spell.startTick = start;
+        spell.ticks = WEATHER_MIN_SPELL_TICKS + (uint32_t)(rng.next() % (WEATHER_MAX_SPELL_TICKS - WEATHER_MIN_SPELL_TICKS + 1));
+        const float roll = rng.nextFloat();
+        if (roll < env.weather.probRain) spell.kind = WEATHER_RAIN;
+        else if (rng.nextFloat() < env.weather.probFog) spell.kind = WEATHER_FOG;
+        else spell.kind = WEATHER_CLEAR;
+        spell.intensity = spell.kind == WEATHER_CLEAR ? 0.0f : rng.range(0.3f, 1.0f);
+        start += spell.ticks;
+    }
+    tables->weatherCycleTicks = start;
+    return tables;
+}
+
+// LRU memo of buildEnvTables, keyed on the fields the tables depend on, so an edited environment
+// with an old id is rebuilt rather than served stale. Entries are shared: one evicted while a
+// game still uses it stays alive until that game lets go. Safe to call from any thread.
+class EnvTableCache {
+private:
+    typedef std::pair<uint64_t, std::shared_ptr<const EnvTables>> Entry;
+
+    size_t capacity;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    std::mutex lock;
+    uint64_t hitCount = 0, missCount = 0;
+
+    static uint64_t keyOf(const EnvConfig& env) {
+        XXH64 h(0x656e76);
+        h.update(&env.seed, sizeof(env.seed));
+        h.update(&env.weather.probRain, sizeof(float));
+        h.update(&env.weather.probFog, sizeof(float));
+        h.update(env.visual.bgType.data(), env.visual.bgType.size());
+        return h.digest();
+    }
+
+public:
+    explicit EnvTableCache(size_t maxEntries = 64) : capacity(maxEntries < 1 ? 1 : maxEntries) {}
+
+    std::shared_ptr<const EnvTables> get(const EnvConfig& env) {
+        const uint64_t key = keyOf(env);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto found = index.find(key);
+            if (found != index.end()) {
+                entries.splice(entries.begin(), entries, found->second);
+                hitCount++;
+                return found->second->second;
+            }
+            missCount++;
+        }
+        // Build outside the lock; two threads missing on the same key both build, and the second
+        // insert just refreshes the entry
+        std::shared_ptr<const EnvTables> tables = buildEnvTables(env);
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->second;
+        }
+        entries.emplace_front(key, tables);
+        index[key] = entries.begin();
+        if (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        return tables;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> guard(lock);
+        return entries.size();
+    }
+
+    uint64_t hits() {
+        std::lock_guard<std::mutex> guard(lock);
+        return hitCount;
+    }
+
+    uint64_t misses() {
+        std::lock_guard<std::mutex> guard(lock);
+        return missCount;
+    }
+};
+
+} // namespace Sim
+
+#endif // ENV_GENERATOR_H
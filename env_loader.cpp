@@ -1,88 +1,175 @@
-// env_loader.cpp - example: load environments.json using nlohmann/json
-// This is a lightweight example; add nlohmann/json single header or link the library.
-
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <vector>
-#if defined(__has_include)
-#  if __has_include(<nlohmann/json.hpp>)
-#    include <nlohmann/json.hpp>
-#    define HW_HAS_NLOHMANN_JSON 1
-#  elif __has_include("json.hpp")
-#    include "json.hpp"
-#    define HW_HAS_NLOHMANN_JSON 1
-#  else
-#    define HW_HAS_NLOHMANN_JSON 0
-#  endif
-#else
-#  include <nlohmann/json.hpp>
-#  define HW_HAS_NLOHMANN_JSON 1
-#endif
-
-#if HW_HAS_NLOHMANN_JSON
-using json = nlohmann::json;
-#else
-// If nlohmann/json.hpp is not available at compile time, provide a graceful runtime fallback.
-// The loader will print a helpful message and return an empty list so the program still builds.
-inline void require_nlohmann_notice() {
-    std::cerr << "nlohmann/json.hpp not found. To enable environment loading, download the single-header 'json.hpp' from https://github.com/nlohmann/json and place it in the project folder or install the library.\n";
-}
-#endif
-
-struct EnvConfig {
-    std::string id;
-    std::string name;
-    int seed;
-    float friction;
-    float speedMultiplier;
-    float obstacleDensity;
-    float powerupDensity;
-    std::string bgType;
-};
-
-std::vector<EnvConfig> loadEnvironments(const std::string &path) {
-#if HW_HAS_NLOHMANN_JSON
-    std::ifstream in(path);
-    if(!in) {
-        std::cerr << "Cannot open " << path << std::endl;
-        return {};
-    }
-    json arr;
-    try {
-        in >> arr;
-    } catch (const std::exception &ex) {
-        std::cerr << "Failed to parse JSON: " << ex.what() << std::endl;
-        return {};
-    }
-    if (!arr.is_array()) {
-        std::cerr << "Expected JSON array in " << path << std::endl;
-        return {};
-    }
-    std::vector<EnvConfig> envs;
-    for(auto &e : arr) {
-        EnvConfig c;
-        c.id = e.value("id", "");
-        c.name = e.value("name", "");
-        c.seed = e.value("seed", 0);
-        c.friction = e.value("friction", 1.0f);
-        c.speedMultiplier = e.value("speedMultiplier", 1.0f);
-        c.obstacleDensity = e.value("obstacleDensity", 0.04f);
-        c.powerupDensity = e.value("powerupDensity", 0.02f);
-        if(e.contains("visual") && e["visual"].contains("bgType")) c.bgType = e["visual"]["bgType"].get<std::string>();
-        envs.push_back(c);
-    }
-    return envs;
-#else
-    require_nlohmann_notice();
-    return {};
-#endif
-}
-
-int main(){
-    auto envs = loadEnvironments("environments.json");
-    for(auto &e: envs) {
-        std::cout << "Env: "<< e.id << " friction="<< e.friction << " speedMul="<< e.speedMultiplier << "\n";
-    }
-    return 0;
-}
+// env_loader.cpp - load and list environments.json with the built-in parser (env_config.h)
+//   env_loader [file]             list the environments of `file` (default environments.json)
+//   env_loader --bench [count]    time parsing a generated file of `count` environments
+//                                 (default 100000); compares against nlohmann/json when its
+//                                 header is available
+//   env_loader --procedural <seed> [count]
+//                                 list `count` procedural environments from `seed` on
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "env_config.h"
+#include "env_generator.h"
+
+#if defined(__has_include)
+#  if __has_include(<nlohmann/json.hpp>)
+#    include <nlohmann/json.hpp>
+#    define HW_HAS_NLOHMANN_JSON 1
+#  elif __has_include("json.hpp")
+#    include "json.hpp"
+#    define HW_HAS_NLOHMANN_JSON 1
+#  endif
+#endif
+#ifndef HW_HAS_NLOHMANN_JSON
+#  define HW_HAS_NLOHMANN_JSON 0
+#endif
+
+// `count` environments cycling through three shapes like the shipped file, with varied numbers
+static std::string generateEnvironments(int count) {
+    static const char* const NAMES[] = { "City Night", "Mountain Pass", "Tropical Jungle" };
+    static const char* const BG_TYPES[] = { "city", "mountain", "jungle" };
+    std::string text = "[\n";
+    char buffer[512];
+    for (int i = 0; i < count; ++i) {
+        const int k = i % 3;
+        std::snprintf(buffer, sizeof(buffer),
+            "  {\n"
+            "    \"id\": \"env_%d\",\n"
+            "    \"name\": \"%s %d\",\n"
+            "    \"seed\": %d,\n"
+            "    \"friction\": %.3f,\n"
+            "    \"speedMultiplier\": %.3f,\n"
+            "    \"obstacleDensity\": %.3f,\n"
+            "    \"powerupDensity\": %.4f,\n"
+            "    \"laneRumble\": %s,\n"
+            "    \"weather\": { \"probRain\": %.2f, \"probFog\": %.2f },\n"
+            "    \"visual\": { \"skyColor\": \"#%06x\", \"bgType\": \"%s\" }\n"
+            "  }%s\n",
+            i, NAMES[k], i, (i * 7919) % 100000, 1.0 + (i % 25) * 0.01, 0.85 + (i % 16) * 0.01,
+            0.02 + (i % 7) * 0.01, 0.01 + (i % 5) * 0.0025, (i & 1) ? "true" : "false",
+            (i % 10) * 0.06, (i % 6) * 0.05, (unsigned)((i * 2654435761u) & 0xffffff), BG_TYPES[k],
+            i + 1 < count ? "," : "");
+        text += buffer;
+    }
+    text += "]\n";
+    return text;
+}
+
+#if HW_HAS_NLOHMANN_JSON
+// The loader this tool used before env_config.h: a full DOM, then field lookups
+static std::vector<Sim::EnvConfig> parseWithNlohmann(const std::string& text) {
+    nlohmann::json arr = nlohmann::json::parse(text);
+    std::vector<Sim::EnvConfig> envs;
+    for (auto& e : arr) {
+        Sim::EnvConfig c;
+        c.id = e.value("id", "");
+        c.name = e.value("name", "");
+        c.seed = e.value("seed", 0);
+        c.friction = e.value("friction", 1.0f);
+        c.speedMultiplier = e.value("speedMultiplier", 1.0f);
+        c.obstacleDensity = e.value("obstacleDensity", 0.04f);
+        c.powerupDensity = e.value("powerupDensity", 0.02f);
+        c.laneRumble = e.value("laneRumble", false);
+        if (e.contains("weather")) {
+            c.weather.probRain = e["weather"].value("probRain", 0.0f);
+            c.weather.probFog = e["weather"].value("probFog", 0.0f);
+        }
+        if (e.contains("visual")) {
+            Json::parseHexColor(e["visual"].value("skyColor", "#000"), c.visual.skyColor);
+            c.visual.bgType = e["visual"].value("bgType", "");
+        }
+        envs.push_back(c);
+    }
+    return envs;
+}
+#endif
+
+// Best of `runs` timings of parse(), in seconds
+template <typename Parse>
+static double bestOf(int runs, Parse parse) {
+    double best = 1e30;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        parse();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+static void report(const char* label, double seconds, size_t bytes, size_t count) {
+    std::printf("%-10s %8.1f ms  %7.1f MB/s  %6.2f M envs/s\n", label, seconds * 1e3,
+                bytes / seconds / 1e6, count / seconds / 1e6);
+}
+
+static int bench(int count) {
+    const std::string text = generateEnvironments(count);
+    std::printf("%d environments, %.1f MB\n", count, text.size() / 1e6);
+
+    std::vector<Sim::EnvConfig> envs;
+    std::string message;
+    const double builtIn = bestOf(5, [&] {
+        if (!Sim::parseEnvironments(text, envs, message)) std::cerr << "Error: " << message << std::endl;
+    });
+    report("built-in", builtIn, text.size(), envs.size());
+
+    // Visiting without collecting is the streaming cost on its own
+    size_t visited = 0;
+    const double streaming = bestOf(5, [&] {
+        visited = 0;
+        Json::Reader reader(text);
+        Sim::readEnvironments(reader, message, [&](const Sim::EnvConfig&) { visited++; });
+    });
+    report("visit only", streaming, text.size(), visited);
+
+#if HW_HAS_NLOHMANN_JSON
+    std::vector<Sim::EnvConfig> reference;
+    const double dom = bestOf(5, [&] { reference = parseWithNlohmann(text); });
+    report("nlohmann", dom, text.size(), reference.size());
+    bool same = reference.size() == envs.size();
+    for (size_t i = 0; same && i < envs.size(); ++i) {
+        const Sim::EnvConfig& a = envs[i];
+        const Sim::EnvConfig& b = reference[i];
+        same = a.id == b.id && a.name == b.name && a.seed == b.seed && a.friction == b.friction
+            && a.speedMultiplier == b.speedMultiplier && a.obstacleDensity == b.obstacleDensity
+            && a.powerupDensity == b.powerupDensity && a.laneRumble == b.laneRumble
+            && a.weather.probRain == b.weather.probRain && a.weather.probFog == b.weather.probFog
+            && a.visual.skyColor == b.visual.skyColor && a.visual.bgType == b.visual.bgType;
+    }
+    std::printf("speedup %.1fx, results %s\n", dom / builtIn, same ? "identical" : "DIFFER");
+    return same ? 0 : 1;
+#else
+    std::printf("nlohmann/json.hpp not found; built-in timings only\n");
+    return 0;
+#endif
+}
+
+static void print(const Sim::EnvConfig& e) {
+    std::cout << "Env: " << e.id << " friction=" << e.friction << " speedMul=" << e.speedMultiplier
+              << " rain=" << e.weather.probRain << " fog=" << e.weather.probFog
+              << " bg=" << e.visual.bgType << "\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        return bench(argc >= 3 ? std::max(1, std::atoi(argv[2])) : 100000);
+    }
+    if (argc >= 3 && std::string(argv[1]) == "--procedural") {
+        const uint64_t seed = std::strtoull(argv[2], nullptr, 0);
+        const int count = argc >= 4 ? std::max(1, std::atoi(argv[3])) : 1;
+        for (int i = 0; i < count; ++i) print(Sim::generateEnvConfig(seed + (uint64_t)i));
+        return 0;
+    }
+    const std::string path = argc >= 2 ? argv[1] : "environments.json";
+    std::vector<Sim::EnvConfig> envs;
+    std::string message;
+    if (!Sim::loadEnvironments(path, envs, message)) {
+        std::cerr << "Error: " << message << std::endl;
+        return 1;
+    }
+    for (const Sim::EnvConfig& e : envs) print(e);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// fixed_point.h
+// Fixed-point scalar and table sine for bit-exact simulation across compilers and flags
+// Enable with -DHW_FIXED_POINT; Sim::Scalar then becomes Sim::Fixed instead of float
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <cstdint>
+
+namespace Sim {
+
+// Signed Q48.16 in an int64. Every operation is integer arithmetic, so results are identical on
+// every compiler, optimization level and FPU. Products must stay below 2^31 in real units
+// (|a * b| < ~2e9), which holds for all simulation quantities (positions, speeds, score deltas).
+class Fixed {
+public:
+    static const int FRAC_BITS = 16;
+    static const int64_t ONE = (int64_t)1 << FRAC_BITS;
+
+    int64_t raw;
+
+    constexpr Fixed() : raw(0) {}
+    constexpr Fixed(int v) : raw((int64_t)v * ONE) {}
+    // Literal/float conversion rounds to nearest; v * 2^16 is exact in double so this is deterministic
+    constexpr Fixed(double v) : raw((int64_t)(v * (double)ONE + (v >= 0 ? 0.5 : -0.5))) {}
+
+    static constexpr Fixed fromRaw(int64_t r) { Fixed f; f.raw = r; return f; }
+
+    float toFloat() const { return (float)raw / (float)ONE; }
+    int toInt() const { return (int)(raw >> FRAC_BITS); } // floor
+
+    Fixed operator-() const { return fromRaw(-raw); }
+    Fixed& operator+=(Fixed o) { raw += o.raw; return *this; }
+    Fixed& operator-=(Fixed o) { raw -= o.raw; return *this; }
+    Fixed& operator*=(Fixed o) { raw = (raw * o.raw) >> FRAC_BITS; return *this; }
+    Fixed& operator/=(Fixed o) { raw = (raw * ONE) / o.raw; return *this; }
+
+    friend Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.raw + b.raw); }
+    friend Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.raw - b.raw); }
+    friend Fixed operator*(Fixed a, Fixed b) { return fromRaw((a.raw * b.raw) >> FRAC_BITS); }
+    friend Fixed operator/(Fixed a, Fixed b) { return fromRaw((a.raw * ONE) / b.raw); }
+    friend Fixed operator*(Fixed a, int b) { return fromRaw(a.raw * b); }
+    friend Fixed operator*(int a, Fixed b) { return fromRaw(a * b.raw); }
+    friend Fixed operator/(Fixed a, int b) { return fromRaw(a.raw / b); }
+
+    friend bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+    friend bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+    friend bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+    friend bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+    friend bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+    friend bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+};
+
+inline Fixed abs(Fixed v) { return v.raw < 0 ? -v : v; }
+
+// Sine from a 1024-entry table (plus one guard entry) with linear interpolation.
+// The table is generated with integer-only arithmetic (Chebyshev recurrence in Q30), so it is
+// bit-identical everywhere, unlike a table filled from std::sin.
+class SineTable {
+public:
+    static const int SIZE = 1024;
+    int32_t values[SIZE + 1]; // Q16
+
+    SineTable() {
+        // 2*cos(2*pi/1024) and sin(2*pi/1024) in Q30
+        const int64_t twoCos = 2147443222ll;
+        const int64_t sinStep = 6588356ll;
+        int64_t prev = 0, cur = sinStep;
+        int64_t q30[SIZE / 4 + 1];
+        q30[0] = 0;
+        q30[1] = cur;
+        for (int i = 2; i <= SIZE / 4; ++i) {
+            int64_t next = ((twoCos * cur) >> 30) - prev;
+            prev = cur;
+            cur = next;
+            q30[i] = cur;
+        }
+        // Mirror the quarter wave to a full period
+        for (int i = 0; i <= SIZE / 4; ++i) {
+            int32_t v = (int32_t)((q30[i] + (1 << 13)) >> 14); // Q30 -> Q16
+            values[i] = v;
+            values[SIZE / 2 - i] = v;
+            values[SIZE / 2 + i] = -v;
+            values[SIZE - i] = -v;
+        }
+    }
+
+    static const SineTable& instance() {
+        static const SineTable table;
+        return table;
+    }
+};
+
+inline Fixed sin(Fixed angle) {
+    // Table steps per radian (1024 / 2pi) in Q16
+    const int64_t stepsPerRadian = 10680707ll;
+    int64_t phase = (angle.raw * stepsPerRadian) >> 16; // Q16 table position
+    int64_t index = phase >> 16;
+    int64_t frac = phase & 0xFFFF;
+    int i = (int)(index & (SineTable::SIZE - 1));
+    const int32_t* t = SineTable::instance().values;
+    return Fixed::fromRaw(t[i] + (((int64_t)(t[i + 1] - t[i]) * frac) >> 16));
+}
+
+} // namespace Sim
+
+#endif // FIXED_POINT_H
@@ -27,6 +27,12 @@ socket.onmessage = (event) => {
     document.getElementById("debug-handbrake").innerText = data.handbrake || false;
 };
 
+// Spawn difficulty curve, kept identical to Sim::Params / Sim::VEHICLE_SPECS in highway_sim.h
+const SPAWN_CURVE = {
+    baseRate: 0.02, maxRate: 0.08, ratePerLevel: 0.005, distancePerRate: 1000000,
+    slowMultiplier: 0.9, speedThinning: 0.7, minRate: 0.006
+};
+
 // Particle class
 class Particle {
     constructor(x, y, vx, vy, size, color, life){
@@ -96,12 +102,13 @@ class HighwayRacingGame {
         this.traffic=[];
         this.trafficSpawnTimer=0;
         this.trafficSpawnRate=0.02;
+        // spawnWeight / levelGrowth / speedGrowth match VEHICLE_SPECS in highway_sim.h
         this.trafficTypes=[
-            { color:'#4444ff', speed:3.2, height:80, width:50, points:10 },
-            { color:'#44ff44', speed:4.2, height:90, width:55, points:15 },
-            { color:'#ff44ff', speed:2.4, height:100, width:60, points:20 },
-            { color:'#ffff44', speed:5.4, height:70, width:45, points:8 },
-            { color:'#44ffff', speed:2.8, height:120, width:65, points:25 }
+            { color:'#4444ff', speed:3.2, height:80, width:50, points:10, spawnWeight:30, levelGrowth:-0.03, speedGrowth:0 },
+            { color:'#44ff44', speed:4.2, height:90, width:55, points:15, spawnWeight:25, levelGrowth:0, speedGrowth:0 },
+            { color:'#ff44ff', speed:2.4, height:100, width:60, points:20, spawnWeight:20, levelGrowth:0.02, speedGrowth:0 },
+            { color:'#ffff44', speed:5.4, height:70, width:45, points:8, spawnWeight:15, levelGrowth:0.1, speedGrowth:0.5 },
+            { color:'#44ffff', speed:2.8, height:120, width:65, points:25, spawnWeight:10, levelGrowth:0.05, speedGrowth:-0.5 }
         ];
 
         // Particles
@@ -384,7 +391,7 @@ class HighwayRacingGame {
         // Road speed from player speed
     this.roadSpeed = 8 + this.player.speed * 0.5;
     // keep a level-based base spawn rate; actual spawn rate will be adjusted by player speed
-    this.trafficBaseSpawnRate = Math.min(0.08, 0.02 + this.level * 0.005);
+    this.trafficBaseSpawnRate = this.getTrafficDensity(this.level, this.distance);
 
         // Update distance and score using dt to be framerate independent
         this.distance += (this.roadSpeed + this.player.speed) * 0.1 * (dt * 60);
@@ -397,6 +404,31 @@ class HighwayRacingGame {
         }
     }
 
+    getTrafficDensity(level, distance) {
+        const c = SPAWN_CURVE;
+        return Math.min(c.maxRate, c.baseRate + level * c.ratePerLevel + distance / c.distancePerRate);
+    }
+
+    // Relative spawn weight of a vehicle type; speedNorm is player speed / max speed
+    calculateSpawnProbability(type, level, speedNorm) {
+        const levelFactor = 1 + (level - 1) * type.levelGrowth;
+        const speedFactor = 1 + speedNorm * type.speedGrowth;
+        return Math.max(0, type.spawnWeight * levelFactor * speedFactor);
+    }
+
+    pickTrafficType() {
+        const speedNorm = Math.min(1, this.player.speed / Math.max(1, this.player.maxSpeed));
+        // Same level cap as the native alias tables
+        const level = Math.min(16, this.level);
+        const weights = this.trafficTypes.map(t => this.calculateSpawnProbability(t, level, speedNorm));
+        let r = Math.random() * weights.reduce((a, b) => a + b, 0);
+        for (let i = 0; i < weights.length; i++) {
+            r -= weights[i];
+            if (r < 0) return this.trafficTypes[i];
+        }
+        return this.trafficTypes[0];
+    }
+
     // Simple in-browser AI FSM for NPC traffic
     updateAI() {
         const difficulty = Math.min(1, Math.max(0, (this.level - 1) * 0.05));
@@ -497,10 +529,12 @@ class HighwayRacingGame {
 
     applyItem(item) {
         if (item.type === 'nitro') {
-            const prevMax = this.player.maxSpeed;
-            this.player.maxSpeed *= 1.6;
+            // another nitro restarts the boost instead of compounding it
+            if (this.nitroTimer) clearTimeout(this.nitroTimer);
+            else this.nitroBaseMax = this.player.maxSpeed;
+            this.player.maxSpeed = this.nitroBaseMax * 1.6;
             this.playSound(1000, 0.15, 'sine');
-            setTimeout(()=>{ this.player.maxSpeed = prevMax; }, 2000);
+            this.nitroTimer = setTimeout(()=>{ this.player.maxSpeed = this.nitroBaseMax; this.nitroTimer = null; }, 2000);
         } else if (item.type === 'pothole') {
             this.player.speed = Math.max(0, this.player.speed * 0.6);
             this.playSound(200,0.12,'sawtooth');
@@ -602,7 +636,7 @@ class HighwayRacingGame {
                     lane = best;
                 }
             }
-                const type = this.trafficTypes[Math.floor(Math.random()*this.trafficTypes.length)];
+                const type = this.pickTrafficType();
             // spawn vehicles a bit farther out so player has a chance to prepare/overtake
             // if player is slow, spawn even farther to avoid immediate collisions
             const spawnBase = 200 + Math.random()*400;
@@ -957,9 +991,9 @@ class HighwayRacingGame {
             // Traffic density: make low-speed traffic LESS dense (to avoid instant pile-ups),
             // and continue to thin strongly at extreme high speeds. Mapping goes from ~0.9 at low speed -> 0.2 at top speed.
             const speedNorm = Math.min(1, this.player.speed / Math.max(1, this.player.maxSpeed));
-            const spawnMultiplier = 0.9 - 0.7 * (speedNorm * speedNorm); // maps 0->0.9 (moderate) to 1->0.2 (sparse)
-            const base = (this.trafficBaseSpawnRate !== undefined) ? this.trafficBaseSpawnRate : 0.02;
-            this.trafficSpawnRate = Math.min(0.12, Math.max(0.006, base * spawnMultiplier));
+            const spawnMultiplier = SPAWN_CURVE.slowMultiplier - SPAWN_CURVE.speedThinning * (speedNorm * speedNorm); // 0->0.9 (moderate) to 1->0.2 (sparse)
+            const base = (this.trafficBaseSpawnRate !== undefined) ? this.trafficBaseSpawnRate : SPAWN_CURVE.baseRate;
+            this.trafficSpawnRate = Math.max(SPAWN_CURVE.minRate, base * spawnMultiplier);
 
             this.spawnTraffic();
             // update items y positions
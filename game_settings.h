@@ -0,0 +1,276 @@
+// game_settings.h
+// Startup settings loaded from config (1).json
+// The file is parsed once into a flat, cache-aligned struct and validated; after that the game
+// reads plain fields (and the sim its Params), never JSON. Defaults are the built-in tuning, so a
+// missing file or key changes nothing. No SFML dependency.
+
+#ifndef GAME_SETTINGS_H
+#define GAME_SETTINGS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "highway_sim.h"
+#include "json_reader.h"
+
+namespace Sim {
+
+struct alignas(64) GameSettings {
+    // Sim tuning, copied into Params
+    int lanes = 3;
+    int playerStartLane = 1;
+    float roadSpeed = 8.0f;
+    float playerWidth = 50.0f;
+    float playerHeight = 80.0f;
+    float playerMaxSpeed = 16.0f;
+    float playerAcceleration = 0.45f;
+    float playerDeceleration = 0.3f;
+    float laneChangeSpeed = 12.0f;
+    float spawnRate = 0.02f;
+    float spawnRateIncrease = 0.005f;
+    float maxSpawnRate = 0.08f;
+    float distancePerLevel = 1000.0f;
+
+    // Window and rendering; colors are 0xRRGGBBAA
+    int canvasWidth = 800;
+    int canvasHeight = 600;
+    int targetFPS = 60;
+    float lineSpacing = 40.0f;
+    float speedBlurThreshold = 8.0f;
+    uint32_t surfaceColor = 0x333333ff;
+    uint32_t lineColor = 0xffffffff;
+    uint32_t edgeColor = 0xffff00ff;
+    uint32_t grassColor = 0x228b22ff;
+    uint32_t playerColor = 0xff4444ff;
+
+    // Budgets
+    int maxParticles = 1000;
+    int particleCount = 20;      // level-up burst
+    int explosionParticles = 50;
+    int maxTrafficVehicles = 64; // vehicle slots at least; wide roads get what they need
+
+    // Traffic types in VEHICLE_SPECS order. The sim's specs are compiled into its spawn tables
+    // and replays, so only the colors are taken from here; the rest is checked against them
+    struct VehicleType {
+        float width, height, baseSpeed, speedVariation, weight;
+        int points;
+        uint32_t color;
+    };
+    VehicleType vehicleTypes[VEHICLE_TYPE_COUNT] = {
+        { 50, 80, 3.0f, 1.0f, 30.0f, 10, 0x4444ffff },
+        { 55, 90, 4.0f, 1.0f, 25.0f, 15, 0x44ff44ff },
+        { 60, 100, 2.0f, 0.5f, 20.0f, 20, 0xff44ffff },
+        { 45, 70, 5.0f, 2.0f, 15.0f, 8, 0xffff44ff },
+        { 65, 120, 2.5f, 0.3f, 10.0f, 25, 0x44ffffff }
+    };
+
+    float laneWidth() const { return (float)canvasWidth / (float)lanes; }
+
+    // Everything except road geometry, which the caller picks (config lanes, --lanes, presets)
+    void applyTuning(Params& p) const {
+        p.baseRoadSpeed = roadSpeed;
+        p.playerWidth = playerWidth;
+        p.playerHeight = playerHeight;
+        p.playerMaxSpeed = playerMaxSpeed;
+        p.playerAcceleration = playerAcceleration;
+        p.playerDeceleration = playerDeceleration;
+        p.laneChangeSpeed = laneChangeSpeed;
+        p.baseSpawnRate = spawnRate;
+        p.spawnRateIncrease = spawnRateIncrease;
+        p.maxSpawnRate = maxSpawnRate;
+        p.distancePerLevel = distancePerLevel;
+    }
+
+    // The configured road: canvas-sized, config lane count and start lane
+    Params params() const {
+        Params p = Params::highway(lanes, laneWidth());
+        p.roadHeight = (float)canvasHeight;
+        p.playerStartLane = playerStartLane;
+        applyTuning(p);
+        return p;
+    }
+};
+
+// Walks the config schema straight into `s`. Unknown keys and sections are skipped, so the web
+// game's extra settings (audio, controls, ...) don't matter here
+inline void readGameSettings(Json::Reader& r, GameSettings& s) {
+    std::string_view section, key, text;
+    auto color = [&](uint32_t& field) {
+        if (r.readString(text) && !Json::parseHexColor(text, field)) r.reject("expected a #rrggbb color");
+    };
+
+    r.beginObject();
+    while (r.nextMember(section)) {
+        if (section == "canvas") {
+            r.beginObject();
+            while (r.nextMember(key)) {
+                if (key == "width") r.readNumber(s.canvasWidth);
+                else if (key == "height") r.readNumber(s.canvasHeight);
+                else r.skipValue();
+            }
+        } else if (section == "road") {
+            r.beginObject();
+            while (r.nextMember(key)) {
+                if (key == "lanes") r.readNumber(s.lanes);
+                else if (key == "speed") r.readNumber(s.roadSpeed);
+                else if (key == "lineSpacing") r.readNumber(s.lineSpacing);
+                else if (key == "edgeColor") color(s.edgeColor);
+                else if (key == "lineColor") color(s.lineColor);
+                else if (key == "surfaceColor") color(s.surfaceColor);
+                else if (key == "grassColor") color(s.grassColor);
+                else r.skipValue();
+            }
+        } else if (section == "player") {
+            r.beginObject();
+            while (r.nextMember(key)) {
+                if (key == "startLane") r.readNumber(s.playerStartLane);
+                else if (key == "width") r.readNumber(s.playerWidth);
+                else if (key == "height") r.readNumber(s.playerHeight);
+                else if (key == "maxSpeed") r.readNumber(s.playerMaxSpeed);
+                else if (key == "acceleration") r.readNumber(s.playerAcceleration);
+                else if (key == "deceleration") r.readNumber(s.playerDeceleration);
+                else if (key == "laneChangeSpeed") r.readNumber(s.laneChangeSpeed);
+                else if (key == "color") color(s.playerColor);
+                else r.skipValue();
+            }
+        } else if (section == "traffic") {
+            r.beginObject();
+            while (r.nextMember(key)) {
+                if (key == "spawnRate") r.readNumber(s.spawnRate);
+                else if (key == "spawnRateIncrease") r.readNumber(s.spawnRateIncrease);
+                else if (key == "maxSpawnRate") r.readNumber(s.maxSpawnRate);
+                else if (key == "vehicleTypes") {
+                    int count = 0;
+                    r.beginArray();
+                    while (r.nextElement()) {
+                        if (count == VEHICLE_TYPE_COUNT) {
+                            r.reject("too many vehicle types");
+                            break;
+                        }
+                        GameSettings::VehicleType& type = s.vehicleTypes[count++];
+                        r.beginObject();
+                        while (r.nextMember(key)) {
+                            if (key == "width") r.readNumber(type.width);
+                            else if (key == "height") r.readNumber(type.height);
+                            else if (key == "baseSpeed") r.readNumber(type.baseSpeed);
+                            else if (key == "speedVariation") r.readNumber(type.speedVariation);
+                            else if (key == "points") r.readNumber(type.points);
+                            else if (key == "weight") r.readNumber(type.weight);
+                            else if (key == "color") color(type.color);
+                            else r.skipValue();
+                        }
+                    }
+                    if (r.ok() && count != VEHICLE_TYPE_COUNT) r.reject("expected one entry per vehicle type");
+                } else {
+                    r.skipValue();
+                }
+            }
+        } else if (section == "gameplay") {
+            r.beginObject();
+            while (r.nextMember(key)) {
+                if (key == "levelProgression") {
+                    r.beginObject();
+                    while (r.nextMember(key)) {
+                        if (key == "distancePerLevel") r.readNumber(s.distancePerLevel);
+                        else r.skipValue();
+                    }
+                } else if (key == "effects") {
+                    r.beginObject();
+                    while (r.nextMember(key)) {
+                        if (key == "speedBlurThreshold") r.readNumber(s.speedBlurThreshold);
+                        else if (key == "particleCount") r.readNumber(s.particleCount);
+                        else if (key == "explosionParticles") r.readNumber(s.explosionParticles);
+                        else r.skipValue();
+                    }
+                } else {
+                    r.skipValue();
+                }
+            }
+        } else if (section == "performance") {
+            r.beginObject();
+            while (r.nextMember(key)) {
+                if (key == "targetFPS") r.readNumber(s.targetFPS);
+                else if (key == "maxParticles") r.readNumber(s.maxParticles);
+                else if (key == "maxTrafficVehicles") r.readNumber(s.maxTrafficVehicles);
+                else r.skipValue();
+            }
+        } else {
+            r.skipValue();
+        }
+    }
+    if (r.ok() && !r.atEnd()) r.reject("unexpected text after the settings object");
+}
+
+// First problem that would break the sim or renderer, or an empty string
+inline std::string validateGameSettings(const GameSettings& s) {
+    if (s.lanes < 1) return "road.lanes must be at least 1";
+    if (s.playerStartLane < 0 || s.playerStartLane >= s.lanes) return "player.startLane must be a lane of the road";
+    if (s.canvasWidth < 100 || s.canvasHeight < 100) return "canvas must be at least 100x100";
+    if (s.playerWidth <= 0 || s.playerHeight <= 0 || s.playerWidth > s.laneWidth()) return "player must fit in a lane";
+    if (s.roadSpeed <= 0 || s.playerMaxSpeed <= 0) return "road.speed and player.maxSpeed must be positive";
+    if (s.playerAcceleration <= 0 || s.playerDeceleration <= 0 || s.laneChangeSpeed <= 0) {
+        return "player acceleration, deceleration and laneChangeSpeed must be positive";
+    }
+    if (s.spawnRate < 0 || s.spawnRateIncrease < 0 || s.maxSpawnRate < s.spawnRate || s.maxSpawnRate > 1) {
+        return "traffic spawn rates must satisfy 0 <= spawnRate <= maxSpawnRate <= 1";
+    }
+    // The sim never spawns below its floor, and traffic chunks are laid out at maxSpawnRate
+    if (s.maxSpawnRate < Params().minSpawnRate) {
+        char message[64];
+        std::snprintf(message, sizeof(message), "traffic.maxSpawnRate must be at least %g", Params().minSpawnRate);
+        return message;
+    }
+    if (s.distancePerLevel <= 0) return "gameplay.levelProgression.distancePerLevel must be positive";
+    if (s.lineSpacing <= 0) return "road.lineSpacing must be positive";
+    if (s.targetFPS < 1) return "performance.targetFPS must be positive";
+    if (s.maxParticles < 0 || s.particleCount < 0 || s.explosionParticles < 0) return "particle counts must not be negative";
+    if (s.maxTrafficVehicles < 1) return "performance.maxTrafficVehicles must be positive";
+    return std::string();
+}
+
+// Vehicle types whose physics differ from the compiled VEHICLE_SPECS (those values are ignored)
+inline std::string vehicleSpecWarnings(const GameSettings& s) {
+    std::string warnings;
+    for (int t = 0; t < VEHICLE_TYPE_COUNT; ++t) {
+        const GameSettings::VehicleType& type = s.vehicleTypes[t];
+        const VehicleSpec& spec = VEHICLE_SPECS[t];
+        if (type.width != spec.width || type.height != spec.height || type.baseSpeed != spec.baseSpeed
+            || type.speedVariation != spec.speedVariation || type.points != spec.points || type.weight != spec.spawnWeight) {
+            warnings += "traffic.vehicleTypes[" + std::to_string(t) + "] physics differ from the built-in specs and are ignored\n";
+        }
+    }
+    return warnings;
+}
+
+// Load and validate `path` into `settings`. On failure `settings` is left untouched and
+// `message` says why; on success `message` holds any warnings
+inline bool loadGameSettings(const std::string& path, GameSettings& settings, std::string& message) {
+    message.clear();
+    std::string text;
+    if (!Json::readFile(path, text)) {
+        message = "cannot open " + path;
+        return false;
+    }
+
+    GameSettings loaded;
+    Json::Reader reader(text);
+    readGameSettings(reader, loaded);
+    if (!reader.ok()) {
+        message = path + ":" + std::to_string(reader.errorLine()) + ": " + reader.errorMessage();
+        return false;
+    }
+    std::string invalid = validateGameSettings(loaded);
+    if (!invalid.empty()) {
+        message = path + ": " + invalid;
+        return false;
+    }
+    message = vehicleSpecWarnings(loaded);
+    settings = loaded;
+    return true;
+}
+
+} // namespace Sim
+
+#endif // GAME_SETTINGS_H
@@ -1,5 +1,5 @@
 // highway_racing.cpp
-// 3-Lane Highway Racing Game in C++ using SFML
+// N-Lane Highway Racing Game in C++ using SFML (3 lanes by default)
 // Standalone version with complete game mechanics
 
 #include <SFML/Graphics.hpp>
@@ -14,6 +14,18 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cstdlib>
+#include <thread>
+#include <memory>
+#include "highway_sim.h"
+#include "chunk_stream.h"
+#include "ecs.h"
+#include "phase_graph.h"
+#include "game_settings.h"
+#include "env_generator.h"
+#include "weather.h"
+#include "hot_reload.h"
+#include "replay.h"
 
 // Ensure M_PI is available
 #ifndef M_PI
@@ -35,133 +47,136 @@ namespace Math {
     }
 }
 
-// Game configuration
+sf::Color toColor(uint32_t rgba) {
+    return sf::Color((sf::Uint8)(rgba >> 24), (sf::Uint8)(rgba >> 16), (sf::Uint8)(rgba >> 8), (sf::Uint8)rgba);
+}
+
+// Game configuration (rendering only; mechanics live in Sim::Params). Filled from the loaded
+// settings before the game starts, and again between frames when the config file is reloaded
 struct Config {
-    const unsigned WINDOW_WIDTH = 800;
-    const unsigned WINDOW_HEIGHT = 600;
-    const unsigned LANES = 3;
-    const float LANE_WIDTH = WINDOW_WIDTH / (float)LANES;
-    
-    // Colors
-    const sf::Color ROAD_COLOR = sf::Color(51, 51, 51);
-    const sf::Color LINE_COLOR = sf::Color::White;
-    const sf::Color EDGE_COLOR = sf::Color::Yellow;
-    const sf::Color GRASS_COLOR = sf::Color(34, 139, 34);
-    
-    // Game mechanics
-    const float BASE_ROAD_SPEED = 8.0f;
-    const float PLAYER_MAX_SPEED = 16.0f; // increased top speed
-    const float PLAYER_ACCELERATION = 0.45f; // quicker acceleration
-    const float PLAYER_DECELERATION = 0.3f; // slightly stronger braking
-    const float LANE_CHANGE_SPEED = 12.0f; // faster lane change
-    // Increased for snappier player control
-    const float PLAYER_MAX_SPEED_UPGRADED = 16.0f; // not used directly - kept for reference
-    
-    // Traffic
-    const float BASE_SPAWN_RATE = 0.02f;
-    const float MAX_SPAWN_RATE = 0.08f;
-    const float SPAWN_RATE_INCREASE = 0.005f;
-    
-    // Scoring
-    const float DISTANCE_PER_LEVEL = 1000.0f;
+    unsigned WINDOW_WIDTH = 800;
+    unsigned WINDOW_HEIGHT = 600;
+    unsigned TARGET_FPS = 60;
+    
+    // Camera zoom (world px per screen px). Past DETAIL_ZOOM traffic is drawn as plain quads
+    static constexpr float MIN_ZOOM = 0.5f;
+    static constexpr float MAX_ZOOM = 40.0f;
+    static constexpr float ZOOM_STEP = 1.25f;
+    static constexpr float DETAIL_ZOOM = 3.0f;
+    float DASH_SPACING = 40.0f;
+    float SPEED_BLUR_THRESHOLD = 8.0f;
+    
+    // Budgets
+    int MAX_PARTICLES = 1000;
+    int LEVEL_UP_PARTICLES = 20;
+    int EXPLOSION_PARTICLES = 50;
+    int MAX_TRAFFIC_VEHICLES = 64;
+    
+    // Colors; traffic is indexed like Sim::VEHICLE_SPECS
+    sf::Color ROAD_COLOR = sf::Color(51, 51, 51);
+    sf::Color LINE_COLOR = sf::Color::White;
+    sf::Color EDGE_COLOR = sf::Color::Yellow;
+    sf::Color GRASS_COLOR = sf::Color(34, 139, 34);
+    sf::Color PLAYER_COLOR = sf::Color(255, 68, 68);
+    sf::Color TRAFFIC_COLORS[Sim::VEHICLE_TYPE_COUNT];
+    
+    void apply(const Sim::GameSettings& s) {
+        WINDOW_WIDTH = (unsigned)s.canvasWidth;
+        WINDOW_HEIGHT = (unsigned)s.canvasHeight;
+        TARGET_FPS = (unsigned)s.targetFPS;
+        DASH_SPACING = s.lineSpacing;
+        SPEED_BLUR_THRESHOLD = s.speedBlurThreshold;
+        MAX_PARTICLES = s.maxParticles;
+        LEVEL_UP_PARTICLES = s.particleCount;
+        EXPLOSION_PARTICLES = s.explosionParticles;
+        MAX_TRAFFIC_VEHICLES = s.maxTrafficVehicles;
+        ROAD_COLOR = toColor(s.surfaceColor);
+        LINE_COLOR = toColor(s.lineColor);
+        EDGE_COLOR = toColor(s.edgeColor);
+        GRASS_COLOR = toColor(s.grassColor);
+        PLAYER_COLOR = toColor(s.playerColor);
+        for (int t = 0; t < Sim::VEHICLE_TYPE_COUNT; ++t) TRAFFIC_COLORS[t] = toColor(s.vehicleTypes[t].color);
+    }
 } CFG;
 
-// Vehicle types for procedural traffic generation
-struct VehicleType {
-    sf::Color color;
-    sf::Vector2f size;
-    float baseSpeed;
-    float speedVariation;
-    int points;
-    float spawnWeight;
-    std::string name;
+// Render color per item type, indexed like Sim::ITEM_SPECS (game.js draw colors)
+const sf::Color ITEM_COLORS[Sim::ITEM_TYPE_COUNT] = {
+    sf::Color(34, 34, 34),   // Pothole
+    sf::Color(255, 136, 0),  // Nitro
+    sf::Color(0, 191, 255),  // Shield
+    sf::Color(255, 215, 0)   // Coin
 };
 
-class TrafficGenerator {
-private:
-    std::vector<VehicleType> vehicleTypes;
-    std::random_device rd;
-    std::mt19937 gen;
-    std::uniform_real_distribution<> dis;
-    
-public:
-    TrafficGenerator() : gen(rd()), dis(0.0, 1.0) {
-        // Define various vehicle types with different characteristics
-        vehicleTypes = {
-            { sf::Color(68, 68, 255), sf::Vector2f(50, 80), 3.0f, 1.0f, 10, 30.0f, "Compact" },
-            { sf::Color(68, 255, 68), sf::Vector2f(55, 90), 4.0f, 1.0f, 15, 25.0f, "Sedan" },
-            { sf::Color(255, 68, 255), sf::Vector2f(60, 100), 2.0f, 0.5f, 20, 20.0f, "SUV" },
-            { sf::Color(255, 255, 68), sf::Vector2f(45, 70), 5.0f, 2.0f, 8, 15.0f, "Sports" },
-            { sf::Color(68, 255, 255), sf::Vector2f(65, 120), 2.5f, 0.3f, 25, 10.0f, "Truck" }
-        };
-    }
-    
-    VehicleType getRandomVehicleType() {
-        // Weighted random selection
-        float totalWeight = 0;
-        for (const auto& type : vehicleTypes) {
-            totalWeight += type.spawnWeight;
-        }
-        
-        float random = dis(gen) * totalWeight;
-        float currentWeight = 0;
-        
-        for (const auto& type : vehicleTypes) {
-            currentWeight += type.spawnWeight;
-            if (random <= currentWeight) {
-                return type;
-            }
-        }
-        
-        return vehicleTypes[0]; // Fallback
-    }
-    
-    float getRandomFloat(float min, float max) {
-        return min + dis(gen) * (max - min);
+// Particle components. Particles are entities of one archetype; each behavior is a system over
+// the component columns it needs
+struct Position { sf::Vector2f value; };
+struct Velocity { sf::Vector2f value; };
+struct Tint { sf::Color value; };
+struct Lifetime { float life, maxLife; };
+struct Radius { float value; };
+
+typedef Ecs::Archetype<Position, Velocity, Tint, Lifetime, Radius> ParticleArchetype;
+
+void moveSystem(size_t count, Position* position, const Velocity* velocity) {
+    for (size_t i = 0; i < count; i++) position[i].value += velocity[i].value;
+}
+
+void fadeSystem(size_t count, Lifetime* lifetime, Tint* tint) {
+    for (size_t i = 0; i < count; i++) {
+        lifetime[i].life -= 1.0f;
+        float alpha = std::max(0.0f, lifetime[i].life / lifetime[i].maxLife);
+        tint[i].value.a = (sf::Uint8)(255 * alpha);
     }
-    
-    int getRandomInt(int min, int max) {
-        return min + (int)(dis(gen) * (max - min + 1));
+}
+
+// Append each particle as an octagon to one triangle batch
+const int PARTICLE_SIDES = 8;
+
+void particleMeshSystem(size_t count, const Position* position, const Radius* radius, const Tint* tint,
+                        sf::VertexArray& mesh) {
+    static const std::vector<sf::Vector2f> corners = [] {
+        std::vector<sf::Vector2f> unit;
+        for (int k = 0; k <= PARTICLE_SIDES; k++) {
+            float a = 2 * (float)M_PI * k / PARTICLE_SIDES;
+            unit.push_back(sf::Vector2f(std::cos(a), std::sin(a)));
+        }
+        return unit;
+    }();
+    for (size_t i = 0; i < count; i++) {
+        sf::Vector2f c = position[i].value;
+        float r = radius[i].value;
+        for (int k = 0; k < PARTICLE_SIDES; k++) {
+            mesh.append(sf::Vertex(c, tint[i].value));
+            mesh.append(sf::Vertex(c + corners[k] * r, tint[i].value));
+            mesh.append(sf::Vertex(c + corners[k + 1] * r, tint[i].value));
+        }
     }
-};
+}
 
 // Particle system for visual effects
-struct Particle {
-    sf::Vector2f position;
-    sf::Vector2f velocity;
-    sf::Color color;
-    float life;
-    float maxLife;
-    float size;
-};
-
 class ParticleSystem {
 private:
-    std::vector<Particle> particles;
+    ParticleArchetype particles;
+    sf::VertexArray mesh;
     std::random_device rd;
     std::mt19937 gen;
     
 public:
-    ParticleSystem() : gen(rd()) {}
+    ParticleSystem() : mesh(sf::Triangles), gen(rd()) {}
     
-    void addExplosion(sf::Vector2f position, int count = 50) {
+    bool full() const { return particles.size() >= (size_t)CFG.MAX_PARTICLES; }
+    
+    void addExplosion(sf::Vector2f position) {
         std::uniform_real_distribution<> dis(-1.0, 1.0);
         std::uniform_real_distribution<> speedDis(5.0, 15.0);
         
-        for (int i = 0; i < count; i++) {
-            Particle p;
-            p.position = position;
-            p.velocity = sf::Vector2f(dis(gen) * speedDis(gen), dis(gen) * speedDis(gen));
-            
-            // Random explosion colors
-            std::vector<sf::Color> colors = {
-                sf::Color::Red, sf::Color::Yellow, sf::Color(255, 165, 0)
-            };
-            p.color = colors[gen() % colors.size()];
-            
-            p.life = p.maxLife = 60.0f + dis(gen) * 60.0f;
-            p.size = 2.0f + dis(gen) * 3.0f;
-            particles.push_back(p);
+        // Random explosion colors
+        const sf::Color colors[] = { sf::Color::Red, sf::Color::Yellow, sf::Color(255, 165, 0) };
+        for (int i = 0; i < CFG.EXPLOSION_PARTICLES && !full(); i++) {
+            sf::Vector2f velocity(dis(gen) * speedDis(gen), dis(gen) * speedDis(gen));
+            float life = 60.0f + dis(gen) * 60.0f;
+            particles.create({ position }, { velocity }, { colors[gen() % 3] }, { life, life },
+                             { 2.0f + (float)dis(gen) * 3.0f });
         }
     }
     
@@ -169,49 +184,35 @@ public:
         std::uniform_real_distribution<> dis(-1.0, 1.0);
         std::uniform_real_distribution<> hueDis(0.0, 360.0);
         
-        for (int i = 0; i < 20; i++) {
-            Particle p;
-            p.position = center + sf::Vector2f(dis(gen) * 100, dis(gen) * 100);
-            p.velocity = sf::Vector2f(dis(gen) * 10, dis(gen) * 10);
+        for (int i = 0; i < CFG.LEVEL_UP_PARTICLES && !full(); i++) {
+            sf::Vector2f position = center + sf::Vector2f(dis(gen) * 100, dis(gen) * 100);
+            sf::Vector2f velocity(dis(gen) * 10, dis(gen) * 10);
             
             // Rainbow colors for level up
             float hue = hueDis(gen);
-            p.color = sf::Color(
+            sf::Color color(
                 (sf::Uint8)(127 * (1 + std::sin(hue * M_PI / 180))),
                 (sf::Uint8)(127 * (1 + std::sin((hue + 120) * M_PI / 180))),
                 (sf::Uint8)(127 * (1 + std::sin((hue + 240) * M_PI / 180)))
             );
-            
-            p.life = p.maxLife = 120.0f;
-            p.size = 3.0f;
-            particles.push_back(p);
+            particles.create({ position }, { velocity }, { color }, { 120.0f, 120.0f }, { 3.0f });
         }
     }
     
     void update() {
-        for (auto it = particles.begin(); it != particles.end();) {
-            it->position += it->velocity;
-            it->life -= 1.0f;
-            
-            // Fade out
-            float alpha = it->life / it->maxLife;
-            it->color.a = (sf::Uint8)(255 * alpha);
-            
-            if (it->life <= 0) {
-                it = particles.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        particles.run<Position, Velocity>(moveSystem);
+        particles.run<Lifetime, Tint>(fadeSystem);
+        const Lifetime* lifetime = particles.column<Lifetime>();
+        particles.destroyIf([&](size_t i) { return lifetime[i].life <= 0; });
     }
     
     void render(sf::RenderWindow& window) {
-        for (const auto& p : particles) {
-            sf::CircleShape circle(p.size);
-            circle.setPosition(p.position.x - p.size, p.position.y - p.size);
-            circle.setFillColor(p.color);
-            window.draw(circle);
-        }
+        if (particles.empty()) return;
+        mesh.clear();
+        particles.run<Position, Radius, Tint>([&](size_t count, const Position* position, const Radius* radius, const Tint* tint) {
+            particleMeshSystem(count, position, radius, tint, mesh);
+        });
+        window.draw(mesh);
     }
     
     void clear() {
@@ -219,214 +220,188 @@ public:
     }
 };
 
-// Traffic vehicle class
-class TrafficVehicle {
+// Screen-space rain and fog over the road. The streaks live in a Sim::RainField; each frame they
+// become one line batch, and fog is a single quad whose alpha thins toward the player
+class WeatherLayer {
+private:
+    Sim::RainField rain;
+    Sim::WeatherLevels levels;
+    sf::VertexArray rainLines;
+    sf::VertexArray fogQuad;
+    
 public:
-    sf::Vector2f position;
-    sf::Vector2f size;
-    sf::Color color;
-    float speed;
-    int points;
-    int lane;
-    float oscillation;
-    float oscillationSpeed;
-    float reactionTime;
-    
-    TrafficVehicle(const VehicleType& type, int startLane, float startY) {
-        size = type.size;
-        color = type.color;
-        speed = type.baseSpeed + (rand() % 100 / 100.0f - 0.5f) * type.speedVariation;
-        points = type.points;
-        lane = startLane;
-        
-        position.x = CFG.LANE_WIDTH * lane + CFG.LANE_WIDTH / 2 - size.x / 2;
-        position.y = startY;
-        
-        oscillation = (rand() % 100 / 100.0f) * 2 * M_PI;
-        oscillationSpeed = 0.01f + (rand() % 100 / 100.0f) * 0.02f;
-        reactionTime = 0.2f + (rand() % 100 / 100.0f) * 0.5f; // seconds-ish reaction time modifier
-    }
-    
-    // Update with basic reaction: roadSpeed is world scroll; playerPos is used by game logic to decide slowdown
-    void update(float roadSpeed, const sf::Vector2f& playerPos) {
-        // Basic proximity-aware slowdown: if the player is close ahead in same lane, reduce forward speed
-        float reactionDistance = 220.0f;
-        float distToPlayerY = position.y - playerPos.y;
-        float slowdown = 0.0f;
-        if (distToPlayerY > -50.0f && distToPlayerY < reactionDistance && std::abs(position.x - playerPos.x) < CFG.LANE_WIDTH * 0.8f) {
-            float urgency = std::max(0.0f, (reactionDistance - distToPlayerY) / reactionDistance);
-            float reactionFactor = std::min(1.0f, urgency / std::max(0.01f, reactionTime));
-            slowdown = 0.3f + 0.7f * reactionFactor; // up to ~1.0
+    WeatherLayer(float width, float height)
+        : rain(width, height), rainLines(sf::Lines, 2 * Sim::RAIN_MAX_STREAKS), fogQuad(sf::Quads, 4) {}
+    
+    // Rain falls faster the faster the road scrolls under it
+    void update(const Sim::WeatherLevels& now, float scroll) {
+        levels = now;
+        rain.setIntensity(levels.rain);
+        rain.update(9.0f + scroll * 0.6f, -1.5f);
+    }
+    
+    void render(sf::RenderWindow& window, float width, float height) {
+        if (levels.fog > 0) {
+            const sf::Uint8 top = (sf::Uint8)(230 * levels.fog), bottom = (sf::Uint8)(70 * levels.fog);
+            fogQuad[0] = sf::Vertex(sf::Vector2f(0, 0), sf::Color(200, 205, 210, top));
+            fogQuad[1] = sf::Vertex(sf::Vector2f(width, 0), sf::Color(200, 205, 210, top));
+            fogQuad[2] = sf::Vertex(sf::Vector2f(width, height), sf::Color(200, 205, 210, bottom));
+            fogQuad[3] = sf::Vertex(sf::Vector2f(0, height), sf::Color(200, 205, 210, bottom));
+            window.draw(fogQuad);
         }
-
-        float desiredSpeed = std::max(0.5f, speed * (1.0f - slowdown));
-        // Blend speed slowly to avoid twitchiness
-        speed += (desiredSpeed - speed) * 0.05f;
-        position.y += speed + roadSpeed;
-
-        // Slight lateral oscillation reduced when slowing
-        oscillation += oscillationSpeed;
-        position.x += std::sin(oscillation) * 0.25f * (1.0f - slowdown);
-    }
-    
-    void render(sf::RenderWindow& window) const {
-        // Shadow
-        sf::RectangleShape shadow(size);
-        shadow.setPosition(position.x + 3, position.y + 3);
-        shadow.setFillColor(sf::Color(0, 0, 0, 80));
-        window.draw(shadow);
-        
-        // Main body
-        sf::RectangleShape body(size);
-        body.setPosition(position);
-        body.setFillColor(color);
-        window.draw(body);
-        
-        // Simple details
-        sf::RectangleShape windshield(sf::Vector2f(size.x - 6, 8));
-        windshield.setPosition(position.x + 3, position.y + 3);
-        windshield.setFillColor(sf::Color(255, 255, 255, 100));
-        window.draw(windshield);
-        
-        // Wheels
-        sf::RectangleShape wheel1(sf::Vector2f(6, 8));
-        sf::RectangleShape wheel2(sf::Vector2f(6, 8));
-        sf::RectangleShape wheel3(sf::Vector2f(6, 8));
-        sf::RectangleShape wheel4(sf::Vector2f(6, 8));
-        
-        wheel1.setPosition(position.x - 2, position.y + 10);
-        wheel2.setPosition(position.x + size.x - 4, position.y + 10);
-        wheel3.setPosition(position.x - 2, position.y + size.y - 18);
-        wheel4.setPosition(position.x + size.x - 4, position.y + size.y - 18);
-        
-        sf::Color wheelColor(17, 17, 17);
-        wheel1.setFillColor(wheelColor);
-        wheel2.setFillColor(wheelColor);
-        wheel3.setFillColor(wheelColor);
-        wheel4.setFillColor(wheelColor);
-        
-        window.draw(wheel1);
-        window.draw(wheel2);
-        window.draw(wheel3);
-        window.draw(wheel4);
-    }
-    
-    sf::FloatRect getBounds() const {
-        return sf::FloatRect(position.x, position.y, size.x, size.y);
+        const int count = rain.size();
+        if (count == 0) return;
+        const float* x = rain.xs();
+        const float* y = rain.ys();
+        const float* depth = rain.depths();
+        const float alpha = 60 + 120 * levels.rain;
+        for (int i = 0; i < count; ++i) {
+            const sf::Color color(170, 190, 220, (sf::Uint8)(alpha * depth[i]));
+            sf::Vertex* line = &rainLines[2 * i];
+            line[0].position = sf::Vector2f(x[i] + 1.5f * depth[i], y[i] - 18 * depth[i]);
+            line[0].color = color;
+            line[1].position = sf::Vector2f(x[i], y[i]);
+            line[1].color = color;
+        }
+        window.draw(&rainLines[0], 2 * count, sf::Lines);
     }
 };
 
-// Player car class
-class PlayerCar {
-public:
-    sf::Vector2f position;
-    sf::Vector2f size;
-    sf::Color color;
-    int currentLane;
-    int targetLane;
-    float speed;
-    bool isChangingLane;
+// Traffic vehicle drawing
+void renderTrafficVehicle(sf::RenderWindow& window, sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+    // Shadow
+    sf::RectangleShape shadow(size);
+    shadow.setPosition(position.x + 3, position.y + 3);
+    shadow.setFillColor(sf::Color(0, 0, 0, 80));
+    window.draw(shadow);
     
-    PlayerCar() {
-        size = sf::Vector2f(50, 80);
-        color = sf::Color(255, 68, 68);
-        currentLane = 1; // Start in lane 1 (0-indexed)
-        targetLane = 1;
-        speed = 0;
-        isChangingLane = false;
-        
-        position.x = CFG.LANE_WIDTH * currentLane + CFG.LANE_WIDTH / 2 - size.x / 2;
-        position.y = CFG.WINDOW_HEIGHT - 120;
-    }
+    // Main body
+    sf::RectangleShape body(size);
+    body.setPosition(position);
+    body.setFillColor(color);
+    window.draw(body);
     
-    void changeLane(int direction) {
-        int newLane = currentLane + direction;
-        if (newLane >= 0 && newLane < (int)CFG.LANES && !isChangingLane) {
-            targetLane = newLane;
-            isChangingLane = true;
-        }
-    }
+    // Simple details
+    sf::RectangleShape windshield(sf::Vector2f(size.x - 6, 8));
+    windshield.setPosition(position.x + 3, position.y + 3);
+    windshield.setFillColor(sf::Color(255, 255, 255, 100));
+    window.draw(windshield);
     
-    void update() {
-        // Handle lane changing
-        if (isChangingLane) {
-            float targetX = CFG.LANE_WIDTH * targetLane + CFG.LANE_WIDTH / 2 - size.x / 2;
-            float diff = targetX - position.x;
+    // Wheels
+    sf::RectangleShape wheel1(sf::Vector2f(6, 8));
+    sf::RectangleShape wheel2(sf::Vector2f(6, 8));
+    sf::RectangleShape wheel3(sf::Vector2f(6, 8));
+    sf::RectangleShape wheel4(sf::Vector2f(6, 8));
+    
+    wheel1.setPosition(position.x - 2, position.y + 10);
+    wheel2.setPosition(position.x + size.x - 4, position.y + 10);
+    wheel3.setPosition(position.x - 2, position.y + size.y - 18);
+    wheel4.setPosition(position.x + size.x - 4, position.y + size.y - 18);
+    
+    sf::Color wheelColor(17, 17, 17);
+    wheel1.setFillColor(wheelColor);
+    wheel2.setFillColor(wheelColor);
+    wheel3.setFillColor(wheelColor);
+    wheel4.setFillColor(wheelColor);
+    
+    window.draw(wheel1);
+    window.draw(wheel2);
+    window.draw(wheel3);
+    window.draw(wheel4);
+}
 
-            float move = std::min(std::abs(diff), CFG.LANE_CHANGE_SPEED);
-            if (std::abs(diff) <= move) {
-                position.x = targetX;
-                currentLane = targetLane;
-                isChangingLane = false;
-            } else {
-                position.x += (diff > 0 ? 1 : -1) * move;
-            }
-        }
-    }
+// Player car drawing
+void renderPlayerCar(sf::RenderWindow& window, sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+    // Shadow
+    sf::RectangleShape shadow(size);
+    shadow.setPosition(position.x + 3, position.y + 3);
+    shadow.setFillColor(sf::Color(0, 0, 0, 100));
+    window.draw(shadow);
     
-    void render(sf::RenderWindow& window) {
-        // Shadow
-        sf::RectangleShape shadow(size);
-        shadow.setPosition(position.x + 3, position.y + 3);
-        shadow.setFillColor(sf::Color(0, 0, 0, 100));
-        window.draw(shadow);
-        
-        // Main body
-        sf::RectangleShape body(size);
-        body.setPosition(position);
-        body.setFillColor(color);
-        window.draw(body);
-        
-        // Windshield
-        sf::RectangleShape windshield(sf::Vector2f(size.x - 10, 15));
-        windshield.setPosition(position.x + 5, position.y + 10);
-        windshield.setFillColor(sf::Color(34, 34, 34));
-        window.draw(windshield);
-        
-        // Rear window
-        sf::RectangleShape rearWindow(sf::Vector2f(size.x - 10, 15));
-        rearWindow.setPosition(position.x + 5, position.y + size.y - 25);
-        rearWindow.setFillColor(sf::Color(34, 34, 34));
-        window.draw(rearWindow);
-        
-        // Headlights
-        sf::RectangleShape headlight1(sf::Vector2f(10, 8));
-        sf::RectangleShape headlight2(sf::Vector2f(10, 8));
-        headlight1.setPosition(position.x + 5, position.y + 5);
-        headlight2.setPosition(position.x + size.x - 15, position.y + 5);
-        headlight1.setFillColor(sf::Color::White);
-        headlight2.setFillColor(sf::Color::White);
-        window.draw(headlight1);
-        window.draw(headlight2);
-        
-        // Wheels
-        sf::RectangleShape wheel1(sf::Vector2f(8, 12));
-        sf::RectangleShape wheel2(sf::Vector2f(8, 12));
-        sf::RectangleShape wheel3(sf::Vector2f(8, 12));
-        sf::RectangleShape wheel4(sf::Vector2f(8, 12));
-        
-        wheel1.setPosition(position.x - 3, position.y + 15);
-        wheel2.setPosition(position.x + size.x - 5, position.y + 15);
-        wheel3.setPosition(position.x - 3, position.y + size.y - 27);
-        wheel4.setPosition(position.x + size.x - 5, position.y + size.y - 27);
-        
-        sf::Color wheelColor(17, 17, 17);
-        wheel1.setFillColor(wheelColor);
-        wheel2.setFillColor(wheelColor);
-        wheel3.setFillColor(wheelColor);
-        wheel4.setFillColor(wheelColor);
-        
-        window.draw(wheel1);
-        window.draw(wheel2);
-        window.draw(wheel3);
-        window.draw(wheel4);
-    }
-    
-    sf::FloatRect getBounds() const {
-        return sf::FloatRect(position.x, position.y, size.x, size.y);
-    }
+    // Main body
+    sf::RectangleShape body(size);
+    body.setPosition(position);
+    body.setFillColor(color);
+    window.draw(body);
+    
+    // Windshield
+    sf::RectangleShape windshield(sf::Vector2f(size.x - 10, 15));
+    windshield.setPosition(position.x + 5, position.y + 10);
+    windshield.setFillColor(sf::Color(34, 34, 34));
+    window.draw(windshield);
+    
+    // Rear window
+    sf::RectangleShape rearWindow(sf::Vector2f(size.x - 10, 15));
+    rearWindow.setPosition(position.x + 5, position.y + size.y - 25);
+    rearWindow.setFillColor(sf::Color(34, 34, 34));
+    window.draw(rearWindow);
+    
+    // Headlights
+    sf::RectangleShape headlight1(sf::Vector2f(10, 8));
+    sf::RectangleShape headlight2(sf::Vector2f(10, 8));
+    headlight1.setPosition(position.x + 5, position.y + 5);
+    headlight2.setPosition(position.x + size.x - 15, position.y + 5);
+    headlight1.setFillColor(sf::Color::White);
+    headlight2.setFillColor(sf::Color::White);
+    window.draw(headlight1);
+    window.draw(headlight2);
+    
+    // Wheels
+    sf::RectangleShape wheel1(sf::Vector2f(8, 12));
+    sf::RectangleShape wheel2(sf::Vector2f(8, 12));
+    sf::RectangleShape wheel3(sf::Vector2f(8, 12));
+    sf::RectangleShape wheel4(sf::Vector2f(8, 12));
+    
+    wheel1.setPosition(position.x - 3, position.y + 15);
+    wheel2.setPosition(position.x + size.x - 5, position.y + 15);
+    wheel3.setPosition(position.x - 3, position.y + size.y - 27);
+    wheel4.setPosition(position.x + size.x - 5, position.y + size.y - 27);
+    
+    sf::Color wheelColor(17, 17, 17);
+    wheel1.setFillColor(wheelColor);
+    wheel2.setFillColor(wheelColor);
+    wheel3.setFillColor(wheelColor);
+    wheel4.setFillColor(wheelColor);
+    
+    window.draw(wheel1);
+    window.draw(wheel2);
+    window.draw(wheel3);
+    window.draw(wheel4);
+}
+
+// Command-line options
+struct GameOptions {
+    std::string recordPath;     // --record <file>: write a replay of each episode
+    uint32_t hashInterval = 60; // --hash-interval <K>: log a state hash every K ticks
+    int warp = 1;               // --warp <K>: simulation ticks per rendered frame
+    int lanes = 0;              // --lanes <N>: road width in lanes (0: from the config)
+    bool rushHour = false;      // --rush-hour: 64-lane stress preset with 5k+ vehicles
+    std::string configPath = "config (1).json"; // --config <file>
+    std::string envId;                              // --env <id>: environment (none: neutral road)
+    std::string environmentsPath = "environments.json"; // --environments <file>
 };
 
+// Road geometry from the options or the config, tuning from the config, then the environment
+Sim::Params simParams(const GameOptions& options, const Sim::GameSettings& settings, const Sim::EnvConfig* environment) {
+    Sim::Params p;
+    if (!options.rushHour && (options.lanes == 0 || options.lanes == settings.lanes)) {
+        p = settings.params();
+    } else {
+        p = options.rushHour ? Sim::Params::rushHour() : Sim::Params::highway(options.lanes, settings.laneWidth());
+        if (!options.rushHour) p.roadHeight = (float)settings.canvasHeight;
+        settings.applyTuning(p);
+    }
+    if (environment) Sim::applyEnvironment(*environment, p);
+    return p;
+}
+
+// Traffic chunks kept generated ahead of the spawn line by background workers
+const int CHUNK_LOOKAHEAD = 4;
+
+// Time-warp steps cycled with the T key
+const int WARP_STEPS[] = { 1, 2, 8, 64 };
+const int WARP_STEP_COUNT = sizeof(WARP_STEPS) / sizeof(WARP_STEPS[0]);
+
 // Main game class
 class HighwayRacingGame {
 private:
@@ -436,39 +411,80 @@ private:
     
     // Game state
     enum GameState { PLAYING, PAUSED, GAME_OVER } gameState;
-    float score;
-    float distance;
-    int level;
-    float maxSpeed;
-    
-    // Game objects
-    PlayerCar player;
-    std::vector<TrafficVehicle> traffic;
-    TrafficGenerator trafficGen;
+    
+    // Headless simulation (one game) holding player, traffic, score and level
+    Sim::World sim;
     ParticleSystem particles;
+    WeatherLayer weather;
+    
+    // Background chunk generation and per-frame phases; declared after sim so they shut down first
+    Sim::JobPool jobs;
+    Sim::ChunkStream chunkStream;
+    Sim::PoolParallelFor simParallel;
+    Sim::PhaseGraph frame;
+    
+    // Results of the sim phase, applied once the frame graph has finished
+    uint32_t frameEvents;
+    float frameScroll;
     
     // Road rendering
-    float roadSpeed;
     float roadOffset;
-    std::vector<float> roadLines;
+    sf::VertexArray dashQuads;
+    sf::VertexArray trafficQuads;
+    sf::VertexArray itemQuads;
     
-    // Traffic spawning
-    float trafficSpawnTimer;
-    float trafficSpawnRate;
+    // Camera following the player across wide roads
+    sf::View camera;
+    float zoom;
     
     // Input
     bool keys[sf::Keyboard::KeyCount];
+    uint32_t simInput;
+    
+    // Time warp: ticks stepped per rendered frame
+    int warp;
     
     // Timing
     sf::Clock gameClock;
     
+    // Replay recording
+    GameOptions options;
+    std::random_device seedSource;
+    Sim::ReplayRecorder recorder;
+    
     // UI elements
-    sf::Text scoreText, speedText, distanceText, levelText;
+    sf::Text scoreText, speedText, distanceText, levelText, warpText;
     sf::Text gameOverText, finalScoreText, restartText;
     
+    // Environment and the tables derived from it (shared spawn tables, weather schedule). The
+    // frame graph reads envTables, so it is only swapped between frames
+    Sim::EnvTableCache envTableCache;
+    std::shared_ptr<const Sim::EnvTables> envTables;
+    
+    // Config hot reload: the watcher thread parses each save into settingsCell (or envCell) and
+    // the main loop picks the newest snapshots up between frames. The watcher is declared last so
+    // it stops first
+    Sim::SnapshotCell<Sim::GameSettings> settingsCell;
+    Sim::SnapshotCell<Sim::EnvConfig> envCell;
+    uint64_t settingsVersion, envVersion;
+    Sim::Params pendingTuning;
+    bool tuningPending;
+    Sim::FileWatcher configWatcher;
+    
 public:
-    HighwayRacingGame() : window(sf::VideoMode(CFG.WINDOW_WIDTH, CFG.WINDOW_HEIGHT), "3-Lane Highway Racing") {
-        window.setFramerateLimit(60);
+    HighwayRacingGame(const GameOptions& opts, const Sim::GameSettings& settings, const Sim::EnvConfig& environment,
+                      const Sim::Params& params)
+        : window(sf::VideoMode(CFG.WINDOW_WIDTH, CFG.WINDOW_HEIGHT),
+                 std::to_string(params.lanes) + "-Lane Highway Racing"),
+          sim(params, 1, std::max(CFG.MAX_TRAFFIC_VEHICLES, params.maxTraffic()), 0),
+          weather((float)CFG.WINDOW_WIDTH, (float)CFG.WINDOW_HEIGHT),
+          jobs((int)std::thread::hardware_concurrency() - 1),
+          chunkStream(jobs, params, CHUNK_LOOKAHEAD), simParallel(jobs),
+          dashQuads(sf::Quads), trafficQuads(sf::Quads), itemQuads(sf::Quads),
+          zoom(opts.rushHour ? 4.0f : 1.0f), warp(std::max(1, opts.warp)), options(opts),
+          envTableCache(8), settingsCell(settings), envCell(environment), settingsVersion(0), envVersion(0),
+          pendingTuning(params), tuningPending(false) {
+        window.setFramerateLimit(CFG.TARGET_FPS);
         
         // Load font
         fontLoaded = font.loadFromFile("arial.ttf");
@@ -477,12 +493,14 @@ public:
         }
         
         // Initialize game state
-        resetGame();
-        
-        // Initialize road lines
-        for (int i = 0; i < 20; i++) {
-            roadLines.push_back((i * 40) - 400);
+        if (!options.envId.empty()) {
+            envTables = envTableCache.get(environment);
+            sim.useSpawnTables(envTables->spawn);
         }
+        sim.setChunkSupplier(0, &chunkStream);
+        sim.setParallelFor(&simParallel);
+        buildFrameGraph();
+        resetGame();
         
         // Clear input array
         for (int i = 0; i < sf::Keyboard::KeyCount; i++) {
@@ -491,39 +509,113 @@ public:
         
         // Setup UI
         setupUI();
+        
+        watchConfig();
     }
     
     void resetGame() {
         gameState = PLAYING;
-        score = 0;
-        distance = 0;
-        level = 1;
-        maxSpeed = 0;
-        roadSpeed = CFG.BASE_ROAD_SPEED;
         roadOffset = 0;
-        trafficSpawnTimer = 0;
-        trafficSpawnRate = CFG.BASE_SPAWN_RATE;
-        
-        player = PlayerCar();
-        traffic.clear();
-        // Seed initial traffic: ensure each non-player lane has at least one vehicle ahead
-        for (int lane = 0; lane < (int)CFG.LANES; ++lane) {
-            if (lane == player.currentLane) continue;
-            VehicleType type = trafficGen.getRandomVehicleType();
-            float spawnY = -type.size.y - trafficGen.getRandomFloat(50.0f, 400.0f) - lane * 80.0f;
-            traffic.emplace_back(type, lane, spawnY);
+        simInput = Sim::INPUT_NONE;
+        
+        // Every episode gets its own seed so it can be replayed from (seed, inputs)
+        uint64_t seed = ((uint64_t)seedSource() << 32) | seedSource();
+        if (tuningPending) {
+            retune(pendingTuning);
+            tuningPending = false;
+        }
+        sim.reset(0, seed);
+        if (!options.recordPath.empty()) {
+            recorder.begin(sim.params, seed, sim.capacity, options.hashInterval);
         }
         particles.clear();
         
         gameClock.restart();
     }
     
+    // Parse on the watcher thread; a file that fails to load or validate leaves the game as it is
+    void watchConfig() {
+        configWatcher.watch(options.configPath, [this] {
+            std::unique_ptr<Sim::GameSettings> fresh(new Sim::GameSettings());
+            std::string message;
+            if (!Sim::loadGameSettings(options.configPath, *fresh, message)) {
+                std::cout << "Warning: " << message << ". Keeping the current settings." << std::endl;
+                return;
+            }
+            if (!message.empty()) std::cout << "Warning: " << message << std::flush;
+            settingsCell.publish(std::move(fresh));
+        });
+        // Procedural environments have no file to watch
+        uint64_t procedural;
+        if (!options.envId.empty() && !Sim::parseProceduralEnvId(options.envId, procedural)) {
+            configWatcher.watch(options.environmentsPath, [this] {
+                std::unique_ptr<Sim::EnvConfig> fresh(new Sim::EnvConfig());
+                std::string message;
+                if (!Sim::findEnvironment(options.envId, options.environmentsPath, *fresh, message)) {
+                    std::cout << "Warning: " << message << ". Keeping the current environment." << std::endl;
+                    return;
+                }
+                envCell.publish(std::move(fresh));
+            });
+        }
+        configWatcher.onIdle([this] {
+            settingsCell.reclaim();
+            envCell.reclaim();
+        });
+        if (!configWatcher.start()) {
+            std::cout << "Warning: Could not watch " << options.configPath << " for changes." << std::endl;
+        }
+    }
+    
+    // Runs between frames, when no phase is reading CFG or stepping the sim. Render settings
+    // change at once and sim tuning from the next tick; the window and road geometry were sized
+    // at startup and keep their values
+    void applyReloadedSettings() {
+        const uint64_t settingsNow = settingsCell.version(), envNow = envCell.version();
+        if (settingsNow == settingsVersion && envNow == envVersion) return;
+        const bool settingsChanged = settingsNow != settingsVersion;
+        settingsVersion = settingsNow;
+        envVersion = envNow;
+        const Sim::GameSettings& s = *settingsCell.read();
+        const Sim::EnvConfig& environment = *envCell.read();
+        
+        const unsigned width = CFG.WINDOW_WIDTH, height = CFG.WINDOW_HEIGHT;
+        if (settingsChanged) {
+            CFG.apply(s);
+            CFG.WINDOW_WIDTH = width;
+            CFG.WINDOW_HEIGHT = height;
+            window.setFramerateLimit(CFG.TARGET_FPS);
+        }
+        
+        Sim::Params tuned = simParams(options, s, options.envId.empty() ? nullptr : &environment);
+        if (!options.envId.empty()) envTables = envTableCache.get(environment);
+        if (tuned.lanes != sim.params.lanes || tuned.roadWidth != sim.params.roadWidth ||
+            tuned.roadHeight != sim.params.roadHeight || (unsigned)s.canvasWidth != width) {
+            std::cout << "Note: lane and canvas changes take effect after a restart." << std::endl;
+        }
+        // A replay holds one set of params per episode, so a recorded episode keeps its tuning
+        // until the next one starts
+        if (!options.recordPath.empty() && gameState != GAME_OVER) {
+            pendingTuning = tuned;
+            tuningPending = true;
+        } else {
+            retune(tuned);
+        }
+        std::cout << "Reloaded " << (settingsChanged ? options.configPath : options.environmentsPath) << std::endl;
+    }
+    
+    void retune(const Sim::Params& tuned) {
+        sim.setTuning(tuned);
+        if (envTables) sim.useSpawnTables(envTables->spawn);
+    }
+    
     void setupUI() {
         if (fontLoaded) {
             scoreText.setFont(font);
             speedText.setFont(font);
             distanceText.setFont(font);
             levelText.setFont(font);
+            warpText.setFont(font);
             gameOverText.setFont(font);
             finalScoreText.setFont(font);
             restartText.setFont(font);
@@ -533,16 +625,19 @@ public:
         speedText.setCharacterSize(20);
         distanceText.setCharacterSize(20);
         levelText.setCharacterSize(20);
+        warpText.setCharacterSize(20);
         
         scoreText.setFillColor(sf::Color::Cyan);
         speedText.setFillColor(sf::Color::Cyan);
         distanceText.setFillColor(sf::Color::Cyan);
         levelText.setFillColor(sf::Color::Cyan);
+        warpText.setFillColor(sf::Color::Yellow);
         
         scoreText.setPosition(10, 10);
         speedText.setPosition(10, 35);
         distanceText.setPosition(CFG.WINDOW_WIDTH - 200, 10);
         levelText.setPosition(CFG.WINDOW_WIDTH - 200, 35);
+        warpText.setPosition(10, 60);
         
         // Game over screen
         gameOverText.setCharacterSize(48);
@@ -573,6 +668,19 @@ public:
                 if (gameState == GAME_OVER && event.key.code == sf::Keyboard::R) {
                     resetGame();
                 }
+                if (event.key.code == sf::Keyboard::T) {
+                    cycleWarp();
+                }
+                if (event.key.code == sf::Keyboard::Equal || event.key.code == sf::Keyboard::Add) {
+                    setZoom(zoom / CFG.ZOOM_STEP);
+                }
+                if (event.key.code == sf::Keyboard::Hyphen || event.key.code == sf::Keyboard::Subtract) {
+                    setZoom(zoom * CFG.ZOOM_STEP);
+                }
+            }
+            
+            if (event.type == sf::Event::MouseWheelScrolled) {
+                setZoom(event.mouseWheelScroll.delta > 0 ? zoom / CFG.ZOOM_STEP : zoom * CFG.ZOOM_STEP);
             }
             
             if (event.type == sf::Event::KeyReleased) {
@@ -590,178 +698,107 @@ public:
             gameState = PLAYING;
         }
         
-        if (gameState == PLAYING) {
-            // Lane changing
-            if (keys[sf::Keyboard::A] || keys[sf::Keyboard::Left]) {
-                player.changeLane(-1);
-            }
-            if (keys[sf::Keyboard::D] || keys[sf::Keyboard::Right]) {
-                player.changeLane(1);
-            }
-            
-            // Acceleration and braking
-            if (keys[sf::Keyboard::W] || keys[sf::Keyboard::Up]) {
-                player.speed = Math::clamp(player.speed + CFG.PLAYER_ACCELERATION, 0, CFG.PLAYER_MAX_SPEED);
-            } else if (keys[sf::Keyboard::S] || keys[sf::Keyboard::Down]) {
-                player.speed = Math::clamp(player.speed - CFG.PLAYER_DECELERATION * 2, 0, CFG.PLAYER_MAX_SPEED);
-            } else {
-                player.speed = Math::clamp(player.speed - CFG.PLAYER_DECELERATION * 0.5f, 0, CFG.PLAYER_MAX_SPEED);
+        // Held keys become simulation input bits; the sim applies them on the next tick
+        simInput = Sim::INPUT_NONE;
+        if (keys[sf::Keyboard::A] || keys[sf::Keyboard::Left]) simInput |= Sim::INPUT_LEFT;
+        if (keys[sf::Keyboard::D] || keys[sf::Keyboard::Right]) simInput |= Sim::INPUT_RIGHT;
+        if (keys[sf::Keyboard::W] || keys[sf::Keyboard::Up]) simInput |= Sim::INPUT_ACCELERATE;
+        else if (keys[sf::Keyboard::S] || keys[sf::Keyboard::Down]) simInput |= Sim::INPUT_BRAKE;
+    }
+    
+    void setZoom(float z) {
+        zoom = Math::clamp(z, CFG.MIN_ZOOM, CFG.MAX_ZOOM);
+    }
+    
+    // Next warp step after the current one, wrapping back to real time
+    void cycleWarp() {
+        int next = WARP_STEPS[0];
+        for (int i = 0; i < WARP_STEP_COUNT; ++i) {
+            if (WARP_STEPS[i] > warp) {
+                next = WARP_STEPS[i];
+                break;
             }
-            
-            maxSpeed = std::max(maxSpeed, player.speed);
         }
+        warp = next;
+    }
+    
+    // Particles only touch visual state, so they run alongside the sim; the road and the rain
+    // move by however far the sim moved this frame
+    void buildFrameGraph() {
+        int simPhase = frame.add("sim", [this] { updateSim(); });
+        frame.add("particles", [this] { particles.update(); });
+        frame.add("road", [this] { updateRoad(); }, { simPhase });
+        frame.add("weather", [this] { updateWeather(); }, { simPhase });
     }
     
     void update() {
         if (gameState != PLAYING) return;
         
-        player.update();
+        frameEvents = 0;
+        frameScroll = 0;
+        frame.run(&jobs);
         
-        // Update road speed based on player speed
-        roadSpeed = CFG.BASE_ROAD_SPEED + player.speed * 0.5f;
-        trafficSpawnRate = Math::clamp(
-            CFG.BASE_SPAWN_RATE + level * CFG.SPAWN_RATE_INCREASE,
-            CFG.BASE_SPAWN_RATE,
-            CFG.MAX_SPAWN_RATE
-        );
-        
-        // Update distance and score
-        distance += (roadSpeed + player.speed) * 0.1f;
-        score += player.speed * 0.5f;
-        
-        // Level progression
-        int newLevel = (int)(distance / CFG.DISTANCE_PER_LEVEL) + 1;
-        if (newLevel > level) {
-            level = newLevel;
-            particles.addLevelUpEffect(sf::Vector2f(CFG.WINDOW_WIDTH / 2, CFG.WINDOW_HEIGHT / 2));
+        // Effects and game over change particles and UI, so they wait for the graph
+        if (frameEvents & Sim::EVENT_LEVEL_UP) {
+            particles.addLevelUpEffect(camera.getCenter());
+        }
+        if (frameEvents & Sim::EVENT_CRASH) {
+            gameOver();
         }
-        
-        // Spawn traffic
-        spawnTraffic();
-        
-        // Update traffic
-        updateTraffic();
-        
-        // Update road
-        updateRoad();
-        
-        // Update particles
-        particles.update();
     }
     
-    void spawnTraffic() {
-        trafficSpawnTimer += trafficSpawnRate;
-        
-        if (trafficSpawnTimer >= 1.0f) {
-            trafficSpawnTimer = 0;
-            // Candidate lanes (exclude player's current lane)
-            std::vector<int> candidateLanes;
-            for (int i = 0; i < (int)CFG.LANES; ++i) {
-                if (i != player.currentLane) candidateLanes.push_back(i);
-            }
-            if (candidateLanes.empty()) return;
-
-            // Determine blocked lanes near the player
-            float safeAhead = 220.0f;
-            float safeBehind = 50.0f;
-            std::vector<bool> laneBlocked(CFG.LANES, false);
-            int blockedCount = 0;
-            for (int lane : candidateLanes) {
-                for (const auto& v : traffic) {
-                    if (v.lane == lane && v.position.y > (player.position.y - safeAhead) && v.position.y < (player.position.y + safeBehind)) {
-                        laneBlocked[lane] = true;
-                        blockedCount++;
-                        break;
-                    }
-                }
-            }
-
-            int chosenLane = -1;
-            // Choose unblocked lane if possible
-            for (int lane : candidateLanes) {
-                if (!laneBlocked[lane]) {
-                    chosenLane = lane;
-                    break;
-                }
-            }
-
-            if (chosenLane == -1) {
-                // All lanes blocked: pick lane with largest gap (farthest nearest vehicle)
-                float bestGap = -1e9f;
-                for (int lane : candidateLanes) {
-                    float nearestY = 1e9f;
-                    for (const auto& v : traffic) if (v.lane == lane) nearestY = std::min(nearestY, v.position.y);
-                    float gap = (nearestY == 1e9f) ? 1e6f : (nearestY - player.position.y);
-                    if (gap > bestGap) { bestGap = gap; chosenLane = lane; }
-                }
-            }
-
-            if (chosenLane != -1) {
-                VehicleType type = trafficGen.getRandomVehicleType();
-                float spawnY = -type.size.y - trafficGen.getRandomFloat(0, 200);
-                TrafficVehicle vehicle(type, chosenLane, spawnY);
-
-                bool canSpawn = true;
-                for (const auto& other : traffic) {
-                    if (std::abs(other.position.x - vehicle.position.x) < 80 && std::abs(other.position.y - vehicle.position.y) < 150) {
-                        canSpawn = false;
-                        break;
-                    }
-                }
-
-                if (canSpawn) {
-                    traffic.push_back(vehicle);
-                }
+    // Warp runs the same per-tick step (and recording) several times before one render,
+    // so physics and replays are identical to real-time play
+    void updateSim() {
+        for (int t = 0; t < warp; ++t) {
+            Sim::StepResult result = sim.step(0, simInput);
+            if (!options.recordPath.empty()) {
+                recorder.recordTick(sim, 0, simInput);
             }
+            frameEvents |= result.events;
+            frameScroll += Sim::toFloat(sim.roadSpeed[0]);
+            if (result.events & Sim::EVENT_CRASH) break;
         }
     }
     
-    void updateTraffic() {
-        for (auto it = traffic.begin(); it != traffic.end();) {
-            it->update(roadSpeed, player.position);
-            
-            // Remove vehicles that are off screen
-            if (it->position.y > CFG.WINDOW_HEIGHT + 50) {
-                score += it->points;
-                it = traffic.erase(it);
-            }
-            // Check collision with player
-            else if (checkCollision(player.getBounds(), it->getBounds())) {
-                gameOver();
-                break;
-            } else {
-                ++it;
-            }
-        }
+    void updateRoad() {
+        // Dashes are laid out from this offset at render time, so they cover any visible stretch
+        roadOffset = std::fmod(roadOffset + frameScroll, CFG.DASH_SPACING);
     }
     
-    bool checkCollision(const sf::FloatRect& a, const sf::FloatRect& b) {
-        return a.intersects(b);
+    // Weather follows the episode's tick through the environment's schedule; none without one
+    void updateWeather() {
+        Sim::WeatherLevels levels;
+        if (envTables) levels = Sim::weatherLevels(*envTables, sim.ticks[0]);
+        weather.update(levels, frameScroll);
     }
     
-    void updateRoad() {
-        roadOffset += roadSpeed;
-        
-        for (auto& lineY : roadLines) {
-            lineY += roadSpeed;
-            if (lineY > CFG.WINDOW_HEIGHT) {
-                lineY = -20 - (rand() % 40);
-            }
-        }
+    // Follow the player sideways; the bottom of the view stays on the road's bottom edge,
+    // so at zoom 1 on the 3-lane road this is exactly the window
+    void updateCamera() {
+        const Sim::Params& p = sim.params;
+        sf::Vector2f size(CFG.WINDOW_WIDTH * zoom, CFG.WINDOW_HEIGHT * zoom);
+        float playerCenter = Sim::toFloat(sim.playerX[0]) + p.playerWidth / 2;
+        float centerX = p.roadWidth <= size.x ? p.roadWidth / 2
+                                              : Math::clamp(playerCenter, size.x / 2, p.roadWidth - size.x / 2);
+        camera.setSize(size.x, size.y);
+        camera.setCenter(centerX, p.roadHeight - size.y / 2);
     }
     
     void gameOver() {
         gameState = GAME_OVER;
+        saveReplay();
+        const Sim::Params& p = sim.params;
         particles.addExplosion(sf::Vector2f(
-            player.position.x + player.size.x / 2,
-            player.position.y + player.size.y / 2
+            Sim::toFloat(sim.playerX[0]) + p.playerWidth / 2,
+            Sim::toFloat(sim.playerY()) + p.playerHeight / 2
         ));
         
         std::stringstream ss;
-        ss << "Final Score: " << (int)score << "\n";
-        ss << "Distance: " << (int)distance << "m\n";
-        ss << "Max Speed: " << (int)(maxSpeed * 10) << " km/h\n";
-        ss << "Level: " << level;
+        ss << "Final Score: " << Sim::toInt(sim.score[0]) << "\n";
+        ss << "Distance: " << Sim::toInt(sim.distance[0]) << "m\n";
+        ss << "Max Speed: " << (int)(Sim::toFloat(sim.maxSpeed[0]) * 10) << " km/h\n";
+        ss << "Level: " << sim.level[0];
         finalScoreText.setString(ss.str());
     }
     
@@ -771,51 +808,34 @@ public:
         // Draw road background
         window.clear(CFG.GRASS_COLOR);
         
-        // Draw lane backgrounds (alternating shades)
-        for (int i = 0; i < (int)CFG.LANES; ++i) {
-            sf::RectangleShape laneRect(sf::Vector2f(CFG.LANE_WIDTH, CFG.WINDOW_HEIGHT));
-            laneRect.setPosition(i * CFG.LANE_WIDTH, 0);
-            if (i % 2 == 0) laneRect.setFillColor(sf::Color(60, 60, 60));
-            else laneRect.setFillColor(sf::Color(46, 46, 46));
-            window.draw(laneRect);
-        }
-
-        // Draw dashed lane dividers
-        for (int i = 1; i < (int)CFG.LANES; i++) {
-            for (float lineY : roadLines) {
-                sf::RectangleShape line(sf::Vector2f(20, 20));
-                line.setPosition(i * CFG.LANE_WIDTH - 10, lineY);
-                line.setFillColor(CFG.LINE_COLOR);
-                window.draw(line);
-            }
-        }
-
-        // Draw strong road edges
-        sf::RectangleShape leftEdge(sf::Vector2f(8, CFG.WINDOW_HEIGHT));
-        sf::RectangleShape rightEdge(sf::Vector2f(8, CFG.WINDOW_HEIGHT));
-        leftEdge.setPosition(0, 0);
-        rightEdge.setPosition(CFG.WINDOW_WIDTH - 8, 0);
-        leftEdge.setFillColor(sf::Color(255, 215, 0));
-        rightEdge.setFillColor(sf::Color(255, 215, 0));
-        window.draw(leftEdge);
-        window.draw(rightEdge);
-        
-    // ... (edges already drawn above)
-        
-        // Draw traffic
-        for (const auto& vehicle : traffic) {
-            vehicle.render(window);
-        }
+        // World-space drawing through the camera; UI below switches back to the default view
+        updateCamera();
+        window.setView(camera);
+        sf::FloatRect visible(camera.getCenter().x - camera.getSize().x / 2,
+                              camera.getCenter().y - camera.getSize().y / 2,
+                              camera.getSize().x, camera.getSize().y);
+        renderRoad(visible);
+        renderItems(visible);
+        renderTraffic(visible);
         
         // Draw player
-        player.render(window);
+        renderPlayerCar(window,
+            sf::Vector2f(Sim::toFloat(sim.playerX[0]), Sim::toFloat(sim.playerY())),
+            sf::Vector2f(sim.params.playerWidth, sim.params.playerHeight),
+            sim.shieldActive[0] ? ITEM_COLORS[Sim::ITEM_SHIELD] : CFG.PLAYER_COLOR);
         
         // Draw particles
         particles.render(window);
         
+        window.setView(window.getDefaultView());
+        
+        // Weather sits over the world and under the UI
+        weather.render(window, (float)CFG.WINDOW_WIDTH, (float)CFG.WINDOW_HEIGHT);
+        
         // Draw speed effects
-        if (player.speed > 8) {
-            sf::Uint8 alpha = (sf::Uint8)((player.speed - 8) * 20);
+        float playerSpeed = Sim::toFloat(sim.playerSpeed[0]);
+        if (playerSpeed > CFG.SPEED_BLUR_THRESHOLD) {
+            sf::Uint8 alpha = (sf::Uint8)std::min(255.0f, (playerSpeed - CFG.SPEED_BLUR_THRESHOLD) * 20);
             for (int i = 0; i < 10; i++) {
                 sf::RectangleShape line(sf::Vector2f(2, 20));
                 line.setPosition(rand() % CFG.WINDOW_WIDTH, rand() % CFG.WINDOW_HEIGHT);
@@ -826,25 +846,32 @@ public:
         
         // Draw UI
         std::stringstream ss;
-        ss << "Score: " << (int)score;
+        ss << "Score: " << Sim::toInt(sim.score[0]);
         scoreText.setString(ss.str());
         window.draw(scoreText);
         
         ss.str("");
-        ss << "Speed: " << (int)(player.speed * 10) << " km/h";
+        ss << "Speed: " << (int)(playerSpeed * 10) << " km/h";
         speedText.setString(ss.str());
         window.draw(speedText);
         
         ss.str("");
-        ss << "Distance: " << (int)distance << "m";
+        ss << "Distance: " << Sim::toInt(sim.distance[0]) << "m";
         distanceText.setString(ss.str());
         window.draw(distanceText);
         
         ss.str("");
-        ss << "Level: " << level;
+        ss << "Level: " << sim.level[0];
         levelText.setString(ss.str());
         window.draw(levelText);
         
+        if (warp > 1) {
+            ss.str("");
+            ss << "Warp: " << warp << "x";
+            warpText.setString(ss.str());
+            window.draw(warpText);
+        }
+        
         // Draw pause screen
         if (gameState == PAUSED) {
             sf::RectangleShape overlay(sf::Vector2f(CFG.WINDOW_WIDTH, CFG.WINDOW_HEIGHT));
@@ -874,19 +901,174 @@ public:
         window.display();
     }
     
+    // Only lanes and dash rows inside the view are drawn, so wide roads cost no more than the screen
+    void renderRoad(const sf::FloatRect& visible) {
+        const Sim::Params& p = sim.params;
+        const float laneWidth = p.laneWidth();
+        const float bottom = visible.top + visible.height;
+        int firstLane = std::max(0, (int)std::floor(visible.left / laneWidth));
+        int lastLane = std::min(p.lanes - 1, (int)std::floor((visible.left + visible.width) / laneWidth));
+        
+        // Draw lane backgrounds (alternating shades)
+        for (int i = firstLane; i <= lastLane; ++i) {
+            sf::RectangleShape laneRect(sf::Vector2f(laneWidth, visible.height));
+            laneRect.setPosition(i * laneWidth, visible.top);
+            if (i % 2 == 0) laneRect.setFillColor(sf::Color(60, 60, 60));
+            else laneRect.setFillColor(sf::Color(46, 46, 46));
+            window.draw(laneRect);
+        }
+        
+        // Draw dashed lane dividers, batched into one vertex array
+        dashQuads.clear();
+        float firstDash = std::floor((visible.top - roadOffset) / CFG.DASH_SPACING) * CFG.DASH_SPACING + roadOffset;
+        for (int i = std::max(1, firstLane); i <= std::min(p.lanes - 1, lastLane + 1); i++) {
+            float x = i * laneWidth - 10;
+            for (float y = firstDash; y < bottom; y += CFG.DASH_SPACING) {
+                dashQuads.append(sf::Vertex(sf::Vector2f(x, y), CFG.LINE_COLOR));
+                dashQuads.append(sf::Vertex(sf::Vector2f(x + 20, y), CFG.LINE_COLOR));
+                dashQuads.append(sf::Vertex(sf::Vector2f(x + 20, y + 20), CFG.LINE_COLOR));
+                dashQuads.append(sf::Vertex(sf::Vector2f(x, y + 20), CFG.LINE_COLOR));
+            }
+        }
+        window.draw(dashQuads);
+        
+        // Draw strong road edges
+        sf::RectangleShape leftEdge(sf::Vector2f(8, visible.height));
+        sf::RectangleShape rightEdge(sf::Vector2f(8, visible.height));
+        leftEdge.setPosition(0, visible.top);
+        rightEdge.setPosition(p.roadWidth - 8, visible.top);
+        leftEdge.setFillColor(CFG.EDGE_COLOR);
+        rightEdge.setFillColor(CFG.EDGE_COLOR);
+        window.draw(leftEdge);
+        window.draw(rightEdge);
+    }
+    
+    // Items of the visible lanes in one draw call. Each lane's ring is ordered bottom to top, so
+    // the walk stops at the first item above the view
+    void renderItems(const sf::FloatRect& visible) {
+        const Sim::Params& p = sim.params;
+        const float top = visible.top - 50, bottom = visible.top + visible.height;
+        int firstLane = std::max(0, (int)std::floor(visible.left / p.laneWidth()));
+        int lastLane = std::min(p.lanes - 1, (int)std::floor((visible.left + visible.width) / p.laneWidth()));
+        itemQuads.clear();
+        for (int lane = firstLane; lane <= lastLane; ++lane) {
+            const int ring = sim.itemRing(0, lane);
+            for (int k = 0; k < sim.itemCount[ring]; ++k) {
+                const int slot = sim.itemRingSlot(ring, k);
+                float y = Sim::toFloat(sim.itemYAt(0, slot));
+                if (y < top) break;
+                if (y > bottom || sim.itemType[slot] == Sim::ITEM_TAKEN) continue;
+                const Sim::ItemSpec& spec = Sim::ITEM_SPECS[sim.itemType[slot]];
+                const sf::Color& color = ITEM_COLORS[sim.itemType[slot]];
+                sf::Vector2f position(p.laneX(lane, spec.width), y);
+                itemQuads.append(sf::Vertex(position, color));
+                itemQuads.append(sf::Vertex(sf::Vector2f(position.x + spec.width, position.y), color));
+                itemQuads.append(sf::Vertex(sf::Vector2f(position.x + spec.width, position.y + spec.height), color));
+                itemQuads.append(sf::Vertex(sf::Vector2f(position.x, position.y + spec.height), color));
+            }
+        }
+        window.draw(itemQuads);
+    }
+    
+    // Traffic inside the view, found through the sim's lane grid. Zoomed far out, vehicles are
+    // a few pixels big, so they are drawn as single-color quads in one draw call.
+    void renderTraffic(const sf::FloatRect& visible) {
+        const float reachX = Sim::MAX_VEHICLE_WIDTH / 2;
+        const bool detailed = zoom <= CFG.DETAIL_ZOOM;
+        trafficQuads.clear();
+        sim.updateGrid(0);
+        sim.visitArea(0, Sim::Scalar(visible.left - reachX), Sim::Scalar(visible.left + visible.width + reachX),
+                      Sim::Scalar(visible.top - Sim::MAX_VEHICLE_HEIGHT), Sim::Scalar(visible.top + visible.height),
+                      [&](int i) {
+            sf::Vector2f position(Sim::toFloat(sim.vehX[i]), Sim::toFloat(sim.vehY[i]));
+            sf::Vector2f size(Sim::toFloat(sim.vehWidth[i]), Sim::toFloat(sim.vehHeight[i]));
+            const sf::Color& color = CFG.TRAFFIC_COLORS[sim.vehType[i]];
+            if (detailed) {
+                renderTrafficVehicle(window, position, size, color);
+            } else {
+                trafficQuads.append(sf::Vertex(position, color));
+                trafficQuads.append(sf::Vertex(sf::Vector2f(position.x + size.x, position.y), color));
+                trafficQuads.append(sf::Vertex(position + size, color));
+                trafficQuads.append(sf::Vertex(sf::Vector2f(position.x, position.y + size.y), color));
+            }
+            return false;
+        });
+        if (!detailed) window.draw(trafficQuads);
+    }
+    
+    void saveReplay() {
+        if (options.recordPath.empty() || recorder.replay.inputs.empty()) return;
+        if (recorder.finish(options.recordPath)) {
+            std::cout << "Replay saved to " << options.recordPath << std::endl;
+        } else {
+            std::cerr << "Warning: could not write replay " << options.recordPath << std::endl;
+        }
+    }
+    
     void run() {
         while (window.isOpen()) {
             handleInput();
+            applyReloadedSettings();
             update();
             render();
         }
+        // Keep the unfinished episode when the window is closed mid-game
+        if (gameState != GAME_OVER) saveReplay();
     }
 };
 
 // Main function
-int main() {
+int main(int argc, char** argv) {
+    GameOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (arg == "--hash-interval" && i + 1 < argc) {
+            options.hashInterval = (uint32_t)std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--warp" && i + 1 < argc) {
+            options.warp = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--lanes" && i + 1 < argc) {
+            options.lanes = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--rush-hour") {
+            options.rushHour = true;
+        } else if (arg == "--config" && i + 1 < argc) {
+            options.configPath = argv[++i];
+        } else if (arg == "--env" && i + 1 < argc) {
+            options.envId = argv[++i];
+        } else if (arg == "--environments" && i + 1 < argc) {
+            options.environmentsPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--record <file>] [--hash-interval <ticks>] [--warp <ticks-per-frame>]"
+                      << " [--lanes <n>] [--rush-hour] [--config <file>] [--env <id>] [--environments <file>]" << std::endl;
+            return 1;
+        }
+    }
+    
+    // Settings are read and validated once; the game only ever sees the resulting plain fields
+    Sim::GameSettings settings;
+    std::string message;
+    if (!Sim::loadGameSettings(options.configPath, settings, message)) {
+        std::cout << "Warning: " << message << ". Using built-in settings." << std::endl;
+    } else if (!message.empty()) {
+        std::cout << "Warning: " << message << std::flush;
+    }
+    CFG.apply(settings);
+    
+    // An environment that can't be found leaves the road neutral
+    Sim::EnvConfig environment;
+    if (!options.envId.empty()) {
+        if (Sim::findEnvironment(options.envId, options.environmentsPath, environment, message)) {
+            std::cout << "Environment: " << environment.name << " (" << environment.id << ")" << std::endl;
+        } else {
+            std::cout << "Warning: " << message << ". Driving without an environment." << std::endl;
+            options.envId.clear();
+        }
+    }
+    
     try {
-        HighwayRacingGame game;
+        HighwayRacingGame game(options, settings, environment,
+                               simParams(options, settings, options.envId.empty() ? nullptr : &environment));
         game.run();
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
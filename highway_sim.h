@@ -0,0 +1,1607 @@
+// highway_sim.h
+// Headless simulation core for the highway racing game
+// Shared by the SFML game (highway_racing.cpp) and the batch environment library (batch_env.cpp)
+// No SFML dependency: state is plain scalars/ints stored as structure-of-arrays
+// Build with -DHW_FIXED_POINT to run the simulation in fixed point (bit-exact on every build)
+
+#ifndef HIGHWAY_SIM_H
+#define HIGHWAY_SIM_H
+
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include "fixed_point.h"
+#include "timer_wheel.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Sim {
+
+const float PI = 3.14159265358979323846f;
+
+// Numeric type of all simulation state. Params stay float; they are converted once per use.
+#ifdef HW_FIXED_POINT
+typedef Fixed Scalar;
+#else
+typedef float Scalar;
+#endif
+
+inline float toFloat(float v) { return v; }
+inline float toFloat(Fixed v) { return v.toFloat(); }
+inline int toInt(float v) { return (int)v; }
+inline int toInt(Fixed v) { return v.toInt(); }
+inline float scalarAbs(float v) { return std::abs(v); }
+inline Fixed scalarAbs(Fixed v) { return abs(v); }
+inline float scalarSin(float v) { return std::sin(v); }
+inline Fixed scalarSin(Fixed v) { return sin(v); } // table sine
+
+// Bit scans for lane masks (mask must be nonzero for lowestBit)
+inline int lowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+inline int bitCount(uint64_t mask) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(mask);
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+// Seedable xorshift64* generator: cheap, deterministic and small enough to keep one per game
+struct Rng {
+    uint64_t state;
+
+    explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        // splitmix64 scramble so consecutive seeds give unrelated streams
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1ull;
+    }
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // Uniform float in [0, 1)
+    float nextFloat() {
+        return (float)(next() >> 40) * (1.0f / 16777216.0f);
+    }
+
+    float range(float min, float max) {
+        return min + nextFloat() * (max - min);
+    }
+};
+
+// Physical description of a traffic vehicle type (colors and names live in the renderer)
+struct VehicleSpec {
+    float width;
+    float height;
+    float baseSpeed;
+    float speedVariation;
+    int points;
+    float spawnWeight;
+    float spawnLevelGrowth; // relative weight change per level past 1
+    float spawnSpeedGrowth; // relative weight change at full player speed
+};
+
+// Keep the spawn columns in sync with trafficTypes in game.js
+const int VEHICLE_TYPE_COUNT = 5;
+const VehicleSpec VEHICLE_SPECS[VEHICLE_TYPE_COUNT] = {
+    { 50, 80, 3.0f, 1.0f, 10, 30.0f, -0.03f, 0.0f },  // Compact
+    { 55, 90, 4.0f, 1.0f, 15, 25.0f, 0.0f, 0.0f },    // Sedan
+    { 60, 100, 2.0f, 0.5f, 20, 20.0f, 0.02f, 0.0f },  // SUV
+    { 45, 70, 5.0f, 2.0f, 8, 15.0f, 0.1f, 0.5f },     // Sports
+    { 65, 120, 2.5f, 0.3f, 25, 10.0f, 0.05f, -0.5f }  // Truck
+};
+
+// Relative spawn probability of a vehicle type; speedNorm is player speed / max speed in [0, 1].
+// Late levels bring more sports cars and trucks; fast players meet fewer trucks
+inline float calculateSpawnProbability(int type, int level, float speedNorm) {
+    const VehicleSpec& spec = VEHICLE_SPECS[type];
+    float levelFactor = 1.0f + (level - 1) * spec.spawnLevelGrowth;
+    float speedFactor = 1.0f + speedNorm * spec.spawnSpeedGrowth;
+    return std::max(0.0f, spec.spawnWeight * levelFactor * speedFactor);
+}
+
+// Walker alias table over vehicle types: one 64-bit draw picks a column and a coin flip, so
+// sampling is O(1). Built and sampled with integer math, keeping fixed-point builds bit-exact.
+struct VehicleAliasTable {
+    uint32_t threshold[VEHICLE_TYPE_COUNT]; // keep the column when the low 32 bits fall below this
+    uint8_t alias[VEHICLE_TYPE_COUNT];
+
+    void build(const float* weights) {
+        const int n = VEHICLE_TYPE_COUNT;
+        uint64_t scaled[VEHICLE_TYPE_COUNT], total = 0;
+        for (int t = 0; t < n; ++t) {
+            scaled[t] = (uint64_t)(std::max(0.0f, weights[t]) * 65536.0f + 0.5f);
+            total += scaled[t];
+        }
+        if (total == 0) {
+            for (int t = 0; t < n; ++t) scaled[t] = 1;
+            total = n;
+        }
+        // Column t holds scaled[t] / total of one column's worth of probability
+        int small[VEHICLE_TYPE_COUNT], large[VEHICLE_TYPE_COUNT], smallCount = 0, largeCount = 0;
+        for (int t = 0; t < n; ++t) {
+            scaled[t] *= n;
+            threshold[t] = UINT32_MAX;
+            alias[t] = (uint8_t)t;
+            if (scaled[t] < total) small[smallCount++] = t;
+            else large[largeCount++] = t;
+        }
+        while (smallCount > 0 && largeCount > 0) {
+            int s = small[--smallCount], l = large[largeCount - 1];
+            threshold[s] = (uint32_t)((scaled[s] << 32) / total);
+            alias[s] = (uint8_t)l;
+            scaled[l] -= total - scaled[s];
+            if (scaled[l] < total) {
+                largeCount--;
+                small[smallCount++] = l;
+            }
+        }
+    }
+
+    int sample(uint64_t r) const {
+        int column = (int)(((r >> 32) * VEHICLE_TYPE_COUNT) >> 32);
+        return (uint32_t)r < threshold[column] ? column : alias[column];
+    }
+};
+
+// Alias tables for every (level, player speed) bucket, built once at startup from
+// calculateSpawnProbability. Levels past the last bucket reuse it. An environment can skew the
+// traffic mix with a per-type weight factor (see env_generator.h)
+const int SPAWN_LEVEL_BUCKETS = 16;
+const int SPAWN_SPEED_BUCKETS = 8;
+
+class SpawnTables {
+public:
+    VehicleAliasTable tables[SPAWN_LEVEL_BUCKETS][SPAWN_SPEED_BUCKETS];
+    float typeBias[VEHICLE_TYPE_COUNT];
+
+    explicit SpawnTables(const float* bias = nullptr) {
+        for (int t = 0; t < VEHICLE_TYPE_COUNT; ++t) typeBias[t] = bias ? bias[t] : 1.0f;
+        float weights[VEHICLE_TYPE_COUNT];
+        for (int l = 0; l < SPAWN_LEVEL_BUCKETS; ++l) {
+            for (int s = 0; s < SPAWN_SPEED_BUCKETS; ++s) {
+                float speedNorm = (s + 0.5f) / SPAWN_SPEED_BUCKETS;
+                for (int t = 0; t < VEHICLE_TYPE_COUNT; ++t) {
+                    weights[t] = calculateSpawnProbability(t, l + 1, speedNorm) * typeBias[t];
+                }
+                tables[l][s].build(weights);
+            }
+        }
+    }
+
+    const VehicleAliasTable& lookup(int level, int speedBucket) const {
+        return tables[std::max(0, std::min(SPAWN_LEVEL_BUCKETS - 1, level - 1))][speedBucket];
+    }
+
+    bool builtFor(const float* bias) const {
+        return std::memcmp(typeBias, bias, sizeof(typeBias)) == 0;
+    }
+
+    static const SpawnTables& instance() {
+        static const SpawnTables spawnTables;
+        return spawnTables;
+    }
+
+    // Tables for a traffic mix: the shared default ones when the mix is neutral
+    static std::shared_ptr<const SpawnTables> forMix(const float* bias) {
+        if (instance().builtFor(bias)) return std::shared_ptr<const SpawnTables>(std::shared_ptr<const SpawnTables>(), &instance());
+        return std::make_shared<const SpawnTables>(bias);
+    }
+};
+
+// Road items (game.js spawnItem/applyItem): potholes are obstacles, the rest are powerups
+enum ItemType : uint8_t {
+    ITEM_POTHOLE = 0,
+    ITEM_NITRO,
+    ITEM_SHIELD,
+    ITEM_COIN,
+    ITEM_TYPE_COUNT,
+    ITEM_TAKEN = 0xff // picked up; the slot is dropped when it scrolls off
+};
+
+struct ItemSpec {
+    float width;
+    float height;
+    float powerupShare; // fraction of powerup rolls that become this item
+    int points;
+};
+
+const ItemSpec ITEM_SPECS[ITEM_TYPE_COUNT] = {
+    { 40, 20, 0.0f, 0 },  // Pothole
+    { 40, 20, 0.4f, 0 },  // Nitro
+    { 40, 20, 0.2f, 0 },  // Shield
+    { 40, 20, 0.4f, 50 }  // Coin
+};
+
+// Largest vehicle footprint; bounds how far a spatial query must reach around a point
+const float MAX_VEHICLE_WIDTH = 65.0f;
+const float MAX_VEHICLE_HEIGHT = 120.0f;
+
+// Row height of the per-game lane grid. At least MAX_VEHICLE_HEIGHT so a query spans few rows
+const float GRID_CELL_HEIGHT = 200.0f;
+
+// Below this many vehicles a linear collision scan beats rebuilding the grid every tick
+const int GRID_MIN_TRAFFIC = 32;
+
+// Lane occupancy bitboard: a lane mask of (lanes + 63) / 64 words per OCCUPANCY_ROW_HEIGHT row.
+// Rows start OCCUPANCY_TOP_MARGIN above the road to cover spawn queries.
+const float OCCUPANCY_ROW_HEIGHT = 32.0f;
+const float OCCUPANCY_TOP_MARGIN = 1024.0f;
+
+// Game mechanics. Defaults are the tuning the SFML game ships with
+struct Params {
+    int lanes = 3;
+    float roadWidth = 800.0f;
+    float roadHeight = 600.0f;
+
+    float playerWidth = 50.0f;
+    float playerHeight = 80.0f;
+    float playerOffsetY = 120.0f; // player sits this far above the bottom edge
+    int playerStartLane = 1;
+
+    float baseRoadSpeed = 8.0f;
+    float playerMaxSpeed = 16.0f;
+    float playerAcceleration = 0.45f;
+    float playerDeceleration = 0.3f;
+    float laneChangeSpeed = 12.0f;
+
+    // Spawn chance per tick (the difficulty curve shared with game.js):
+    //   getTrafficDensity = min(maxSpawnRate, baseSpawnRate + level * spawnRateIncrease + distance / distancePerSpawnRate)
+    //   rate = max(minSpawnRate, density * (spawnSlowMultiplier - spawnSpeedThinning * speedNorm^2))
+    float baseSpawnRate = 0.02f;
+    float maxSpawnRate = 0.08f;
+    float spawnRateIncrease = 0.005f;
+    float distancePerSpawnRate = 1000000.0f;
+    float spawnSlowMultiplier = 0.9f; // fewer spawns at low speed to avoid instant pile-ups
+    float spawnSpeedThinning = 0.7f;  // and thinner still at top speed
+    float minSpawnRate = 0.006f;
+
+    // Traffic is laid out per road chunk of this many px (see generateTrafficChunk)
+    float chunkLength = 1024.0f;
+
+    float distancePerLevel = 1000.0f;
+
+    // Traffic AI (CRUISE / EVADE / OVERTAKE, ported from game.js updateAI)
+    float trafficLaneChangeSpeed = 3.0f; // lateral px per tick while a vehicle changes lanes
+
+    // Car following (Intelligent Driver Model); distances in px, time in ticks
+    float idmMaxAcceleration = 0.08f;
+    float idmComfortDeceleration = 0.15f;
+    float idmMaxDeceleration = 1.0f; // hard cap on braking per tick
+    float idmMinGap = 20.0f;         // bumper-to-bumper gap at standstill
+    float idmTimeHeadway = 10.0f;
+
+    // Lane changes (MOBIL); accelerations in px/tick^2. Politeness is 1 - a driver's aggression
+    float mobilThreshold = 0.02f;       // smallest net gain worth changing lanes for
+    float mobilSafeDeceleration = 0.3f; // the new follower must not have to brake harder than this
+    float mobilEvadeBias = 1.0f;        // extra incentive to clear the lane of an approaching player
+
+    // Traffic volume: multiplier on the spawn rate, and vehicles seeded per lane on reset
+    float trafficDensity = 1.0f;
+    int initialVehiclesPerLane = 1;
+
+    // Items: every itemRowSpacing px of road each lane rolls once; below obstacleDensity it gets
+    // a pothole, below obstacleDensity + powerupDensity a powerup (densities as in environments.json)
+    float obstacleDensity = 0.04f;
+    float powerupDensity = 0.02f;
+    float itemRowSpacing = 400.0f;
+    float itemDrift = 2.0f; // items slide toward the player slightly faster than the road
+    float nitroSpeedMultiplier = 1.6f;
+    int nitroTicks = 120;
+    int shieldTicks = 300;  // crashes and potholes are ignored while a shield is up
+
+    // Environment (see env_generator.h applyEnvironment). Friction makes braking and coasting
+    // stronger and acceleration weaker; speedMultiplier scales acceleration and traffic speeds;
+    // trafficMix weights the vehicle types. The neutral values leave the tuning above as it is
+    float friction = 1.0f;
+    float speedMultiplier = 1.0f;
+    float trafficMix[VEHICLE_TYPE_COUNT] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    float potholeSpeedFactor = 0.6f;
+
+    float laneWidth() const { return roadWidth / (float)lanes; }
+    float playerY() const { return roadHeight - playerOffsetY; }
+    float laneX(int lane, float width) const { return laneWidth() * lane + laneWidth() / 2 - width / 2; }
+
+    // Upper bound on live traffic: spawning keeps vehicles ~150 px apart within a lane
+    int maxTraffic() const { return lanes * ((int)(roadHeight / 150.0f) + 8); }
+
+    // N-lane road with the default lane width (the 3-lane game is highway(3))
+    static Params highway(int laneCount, float laneWidth = 800.0f / 3.0f) {
+        Params p;
+        p.lanes = std::max(1, laneCount);
+        p.roadWidth = laneWidth * p.lanes;
+        p.playerStartLane = p.lanes / 2;
+        return p;
+    }
+
+    // Stress preset: 64 lanes on a 32k px stretch, seeded full and kept at 5k+ vehicles
+    static Params rushHour() {
+        Params p = highway(64, 140.0f);
+        p.roadHeight = 32000.0f;
+        p.trafficDensity = 300.0f;
+        p.initialVehiclesPerLane = 110;
+        return p;
+    }
+};
+
+// Chunked traffic: the road ahead is split into fixed-length chunks whose spawn layout is a pure
+// function of (episode seed, chunk index), so any stretch of road can be rebuilt without
+// simulating up to it, and chunks can be generated ahead of time on any thread. Entries are laid
+// out at the densest level's rate and materialized as their road position crosses the spawn
+// line; level and player speed thinning, blocked lanes and spacing are applied then.
+struct ChunkEntry {
+    Scalar offset;     // road position within the chunk, increasing along the entry list
+    int lane;          // preferred lane; remapped among free lanes if blocked at spawn time
+    uint32_t laneRoll; // uniform bits used for that remap
+    uint64_t typeDraw; // alias table draw, resolved with the level and speed at spawn time
+    Scalar keep;       // uniform [0, 1): kept while below spawn rate / chunk density
+};
+
+struct TrafficChunk {
+    uint64_t seed = 0;
+    int64_t index = -1; // -1: empty buffer
+    Scalar density = 0; // spawn chance per base-speed tick the chunk was laid out for
+    std::vector<ChunkEntry> entries;
+};
+
+// Lay out chunk `index`. Expected entries = density * (chunk length in ticks at base road speed)
+// * trafficDensity, so at base speed the chunks reproduce the per-tick spawn rate
+inline void generateTrafficChunk(const Params& p, uint64_t seed, int64_t index, TrafficChunk& chunk) {
+    Rng r(seed ^ ((uint64_t)index * 0x9E3779B97F4A7C15ull));
+    const Scalar length = p.chunkLength;
+    chunk.seed = seed;
+    chunk.index = index;
+    chunk.density = std::max(p.maxSpawnRate, p.minSpawnRate); // the highest rate spawnTraffic can ask for
+    Scalar expected = chunk.density * (length / Scalar(p.baseRoadSpeed)) * Scalar(p.trafficDensity);
+    int count = toInt(expected + Scalar(r.nextFloat())); // stochastic rounding
+    chunk.entries.resize(count);
+    for (int k = 0; k < count; ++k) {
+        ChunkEntry& e = chunk.entries[k];
+        e.offset = Scalar(r.nextFloat()) * length;
+        e.lane = (int)(((r.next() >> 32) * (uint64_t)p.lanes) >> 32);
+        e.laneRoll = (uint32_t)(r.next() >> 32);
+        e.typeDraw = r.next();
+        e.keep = Scalar(r.nextFloat());
+    }
+    std::sort(chunk.entries.begin(), chunk.entries.end(), [](const ChunkEntry& a, const ChunkEntry& b) {
+        return a.offset < b.offset;
+    });
+}
+
+// Optional source of pre-generated chunks for one game (see chunk_stream.h). take() moves chunk
+// (seed, index) into `into` and returns false if it isn't ready, in which case the World
+// generates it itself; restart() announces a new episode seed, retune() new params from chunk
+// `fromIndex` on.
+class ChunkSupplier {
+public:
+    virtual ~ChunkSupplier() {}
+    virtual void restart(uint64_t seed) = 0;
+    virtual void retune(const Params& p, uint64_t seed, int64_t fromIndex) = 0;
+    virtual bool take(uint64_t seed, int64_t index, TrafficChunk& into) = 0;
+};
+
+// Optional executor for the data-parallel loops inside one game's tick (see phase_graph.h).
+// run() calls body(begin, end) over a partition of [0, count) into pieces of about `grain` items
+// and returns once every call has finished. Loop bodies write disjoint data and draw no random
+// numbers, so results are identical however the range is split.
+class ParallelFor {
+public:
+    virtual ~ParallelFor() {}
+    virtual void run(int count, int grain, const std::function<void(int, int)>& body) = 0;
+};
+
+// Held-key input for one tick
+enum Input : uint32_t {
+    INPUT_NONE = 0,
+    INPUT_ACCELERATE = 1 << 0,
+    INPUT_BRAKE = 1 << 1,
+    INPUT_LEFT = 1 << 2,
+    INPUT_RIGHT = 1 << 3
+};
+
+// Things that happened during a tick which the caller may want to react to (effects, resets)
+enum Event : uint32_t {
+    EVENT_NONE = 0,
+    EVENT_LEVEL_UP = 1 << 0,
+    EVENT_CRASH = 1 << 1,
+    EVENT_ITEM = 1 << 2
+};
+
+// Traffic AI state per vehicle
+enum AiState : uint8_t {
+    AI_CRUISE = 0,
+    AI_EVADE,
+    AI_OVERTAKE
+};
+
+struct StepResult {
+    float reward;    // score gained this tick
+    uint32_t events; // Event bits
+};
+
+// Traffic motion over one contiguous span of vehicles: speeds come from the IDM pass, this only
+// integrates them and adds the slight lateral oscillation. Branch-free so the loop vectorizes.
+inline void updateTrafficSpan(Scalar* __restrict x, Scalar* __restrict y, const Scalar* __restrict speed,
+                              Scalar* __restrict oscillation, const Scalar* __restrict oscillationSpeed,
+                              int count, Scalar roadSpeed) {
+    for (int i = 0; i < count; ++i) {
+        y[i] += speed[i] + roadSpeed;
+        oscillation[i] += oscillationSpeed[i];
+        x[i] += scalarSin(oscillation[i]) * Scalar(0.25f);
+    }
+}
+
+// Intelligent Driver Model constants in simulation units, derived once from Params
+struct IdmCoefficients {
+    Scalar minGap, timeHeadway, maxDeceleration;
+    Scalar approachTerm; // 1 / (2 * sqrt(maxAcceleration * comfortDeceleration))
+
+    explicit IdmCoefficients(const Params& p)
+        : minGap(p.idmMinGap), timeHeadway(p.idmTimeHeadway), maxDeceleration(p.idmMaxDeceleration),
+          approachTerm(1.0f / (2.0f * std::sqrt(p.idmMaxAcceleration * p.idmComfortDeceleration))) {}
+};
+
+// IDM acceleration of a batch of (follower, leader) pairs; `gap` is bumper to bumper.
+// Branch-free so the loop vectorizes.
+//   a = maxAccel * (1 - (v / v0)^4 - (s* / s)^2),  s* = s0 + max(0, v T + v dv / (2 sqrt(a b)))
+inline void idmAccelerationSpan(Scalar* __restrict accel, const Scalar* __restrict speed,
+                                const Scalar* __restrict desiredSpeed, const Scalar* __restrict maxAccel,
+                                const Scalar* __restrict gap, const Scalar* __restrict leaderSpeed,
+                                int count, const IdmCoefficients& c) {
+    const Scalar zero = 0, one = 1;
+    for (int i = 0; i < count; ++i) {
+        Scalar v = speed[i];
+        Scalar ratio = v / std::max(Scalar(0.1f), desiredSpeed[i]);
+        ratio = ratio * ratio;
+        Scalar desiredGap = c.minGap + std::max(zero, v * c.timeHeadway + v * (v - leaderSpeed[i]) * c.approachTerm);
+        Scalar crowding = desiredGap / std::max(one, gap[i]);
+        accel[i] = std::max(-c.maxDeceleration, maxAccel[i] * (one - ratio * ratio - crowding * crowding));
+    }
+}
+
+inline bool overlaps(Scalar ax, Scalar ay, Scalar aw, Scalar ah, Scalar bx, Scalar by, Scalar bw, Scalar bh) {
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+// A set of independent games stored as structure-of-arrays.
+// Game g owns vehicle slots [g * capacity, g * capacity + trafficCount[g]); slots are kept dense.
+// Stepping different games touches disjoint data, so games can be stepped from different threads.
+class World {
+public:
+    Params params;
+    int games;
+    int capacity;
+
+    // Per-game state
+    std::vector<Scalar> playerX, playerSpeed, maxSpeed;
+    std::vector<int> playerLane, playerTargetLane;
+    std::vector<uint8_t> playerChangingLane, crashed;
+    std::vector<Scalar> score, distance, roadSpeed, spawnRate;
+    std::vector<int> level, trafficCount;
+    std::vector<uint64_t> ticks;
+    std::vector<Rng> rng;
+
+    // Chunked traffic: the chunk under the spawn line, how far the line is into it, and the next
+    // entry to spawn. Two buffers per game (by chunk parity) hold the current and next chunk,
+    // so memory stays bounded however far the game goes
+    std::vector<int64_t> chunkIndex;
+    std::vector<Scalar> chunkPos;
+    std::vector<int> chunkCursor;
+    std::vector<uint64_t> chunkSeed;
+    std::vector<TrafficChunk> chunks;
+    std::vector<ChunkSupplier*> chunkSuppliers; // per game, null: generate on the sim thread
+    ParallelFor* parallel = nullptr;            // splits the traffic phases of dense games
+
+    // Per-vehicle state
+    std::vector<Scalar> vehX, vehY, vehWidth, vehHeight, vehSpeed;
+    std::vector<Scalar> vehOscillation, vehOscillationSpeed, vehReactionTime;
+    std::vector<int> vehLane, vehPoints, vehType;
+    std::vector<Scalar> vehBaseSpeed, vehAggression;
+    std::vector<Scalar> vehLateralShift, vehLateralProgress; // active lane change: total dx, 0..1
+    std::vector<int> vehTargetLane;
+    std::vector<uint8_t> vehAiState, vehChangingLane;
+
+    // Lane index: per game, slots grouped by vehLane and sorted by y within each lane (one sort per
+    // tick). A vehicle's leader is simply the next entry in its lane, and a cursor walking the
+    // neighboring lanes in step gives adjacent-lane neighbors in amortized O(1).
+    std::vector<int> laneStart; // per game: lanes + 1 offsets into laneOrder
+    std::vector<int> laneOrder; // per game: `capacity` slot indices
+    std::vector<int> laneRank;  // per slot: its position in laneOrder
+
+    // Neighbors by lane-index position (slot indices, -1 when absent). Leaders have larger y
+    std::vector<int> nbLeader, nbFollower, nbLeftLeader, nbLeftFollower, nbRightLeader, nbRightFollower;
+    IdmCoefficients idm;
+
+    // Lane grid: per game, vehicles bucketed by (lane column of their center, GRID_CELL_HEIGHT row).
+    // Rebuilt lazily by counting sort (at most once per tick), so spawn and collision queries only
+    // visit nearby cells and cost the same on a 3-lane road as on a 64-lane one with thousands of vehicles.
+    int gridRows;
+    int gridCells; // lanes * gridRows
+    std::vector<int> cellStart; // per game: gridCells + 1 offsets into cellItems
+    std::vector<int> cellItems; // per game: `capacity` slot indices ordered by cell
+    std::vector<int> vehCell;
+    std::vector<uint8_t> gridDirty;
+
+    // Occupancy bitboard: per game, occupancyRows lane masks of laneWords words; bit `lane` of row
+    // r is set when a vehicle in that lane column has its top edge in row r. Rebuilt lazily in one
+    // pass, so blocked-lane and gap queries over a y range are an OR of a few words whatever the
+    // traffic.
+    int occupancyRows, laneWords;
+    std::vector<uint64_t> occupancy;
+    static constexpr int SPAWN_MASKS = 3;
+    std::vector<uint64_t> spawnMasks; // per game: candidate, free and scratch lane masks
+    std::vector<int> vehOccupancyRow; // scratch for the rebuild
+    std::vector<uint8_t> occupancyDirty;
+
+    // Items live in one fixed ring per (game, lane), oldest first. Every item moves at the same
+    // speed and a lane gets at most one per row, so each ring stays sorted by y and never holds
+    // more than the rows that fit on the road; collision only walks the player's lanes. Since
+    // they all move together, itemY is relative to a per-game scroll and a tick moves none of
+    // them: use itemYAt() for the on-screen y.
+    int itemLaneCapacity; // power of two
+    std::vector<Scalar> itemY;
+    std::vector<Scalar> itemScroll;       // per game: item travel since the rings were last rebased
+    std::vector<int> itemLive;            // per game: items in all its rings
+    std::vector<uint8_t> itemType;
+    std::vector<int> itemHead, itemCount; // per ring
+    std::vector<Scalar> itemRowPos;       // per game: item travel since the last row was rolled
+    std::vector<Rng> itemRng;             // per game; its own stream so items never shift traffic
+
+    // Timed item effects per game; expiries live on a per-game timer wheel, and picking up an
+    // effect that is already running cancels its expiry and schedules a fresh one
+    std::vector<uint8_t> nitroActive, shieldActive;
+    std::vector<TimerHandle> nitroTimer, shieldTimer;
+    std::vector<TimerWheel> effectTimers;
+
+    World(const Params& p, int gameCount, int vehicleCapacity, uint64_t seed)
+        : params(p), games(gameCount), capacity(vehicleCapacity), idm(p) {
+        laneWidthS = Scalar(params.roadWidth) / params.lanes;
+        playerYS = Scalar(params.roadHeight) - Scalar(params.playerOffsetY);
+        gridRows = (int)std::ceil(params.roadHeight / GRID_CELL_HEIGHT) + 2;
+        invLaneWidthS = Scalar(1) / laneWidthS;
+        invCellHeightS = Scalar(1.0f / GRID_CELL_HEIGHT);
+        gridCells = params.lanes * gridRows;
+        invRowHeightS = Scalar(1.0f / OCCUPANCY_ROW_HEIGHT);
+        occupancyTopS = Scalar(OCCUPANCY_TOP_MARGIN);
+        occupancyRows = (int)std::ceil((params.roadHeight + OCCUPANCY_TOP_MARGIN) / OCCUPANCY_ROW_HEIGHT) + 2;
+        laneWords = (params.lanes + 63) / 64;
+        allLanes.assign(laneWords, ~0ull);
+        if (params.lanes % 64) allLanes.back() = (1ull << (params.lanes % 64)) - 1;
+        // A spawn must stay 80 px (plus half the width difference of two vehicles) from other
+        // centers; on narrow lanes that reaches into the neighboring lane columns
+        spawnLaneReach = (int)std::ceil((80.0f + (MAX_VEHICLE_WIDTH - 45.0f) / 2) / params.laneWidth() + 0.5f) - 1;
+        playerX.assign(games, 0); playerSpeed.assign(games, 0); maxSpeed.assign(games, 0);
+        playerLane.assign(games, 0); playerTargetLane.assign(games, 0);
+        playerChangingLane.assign(games, 0); crashed.assign(games, 0);
+        score.assign(games, 0); distance.assign(games, 0); roadSpeed.assign(games, 0);
+        spawnRate.assign(games, 0);
+        chunkIndex.assign(games, 0); chunkPos.assign(games, 0); chunkCursor.assign(games, 0);
+        chunkSeed.assign(games, 0);
+        chunks.assign((size_t)games * 2, TrafficChunk());
+        chunkSuppliers.assign(games, nullptr);
+        level.assign(games, 1); trafficCount.assign(games, 0);
+        ticks.assign(games, 0);
+        rng.reserve(games);
+        for (int g = 0; g < games; ++g) rng.emplace_back(seed + (uint64_t)g);
+
+        size_t slots = (size_t)games * capacity;
+        vehX.assign(slots, 0); vehY.assign(slots, 0); vehWidth.assign(slots, 0); vehHeight.assign(slots, 0);
+        vehSpeed.assign(slots, 0); vehOscillation.assign(slots, 0); vehOscillationSpeed.assign(slots, 0);
+        vehReactionTime.assign(slots, 0); vehLane.assign(slots, 0); vehPoints.assign(slots, 0); vehType.assign(slots, 0);
+        vehBaseSpeed.assign(slots, 0); vehAggression.assign(slots, 0); vehTargetLane.assign(slots, 0);
+        vehAiState.assign(slots, AI_CRUISE); vehChangingLane.assign(slots, 0);
+        vehLateralShift.assign(slots, 0); vehLateralProgress.assign(slots, 0);
+        laneStart.assign((size_t)games * (params.lanes + 1), 0);
+        laneOrder.assign(slots, 0); laneRank.assign(slots, 0);
+        nbLeader.assign(slots, -1); nbFollower.assign(slots, -1);
+        nbLeftLeader.assign(slots, -1); nbLeftFollower.assign(slots, -1);
+        nbRightLeader.assign(slots, -1); nbRightFollower.assign(slots, -1);
+        rankDesired.assign(slots, 0); rankAccel.assign(slots, 0);
+        size_t evalSlots = slots * EVAL_BLOCKS;
+        evalSpeed.assign(evalSlots, 0); evalDesired.assign(evalSlots, 0); evalMaxAccel.assign(evalSlots, 0);
+        evalGap.assign(evalSlots, 0); evalLeaderSpeed.assign(evalSlots, 0); evalAccel.assign(evalSlots, 0);
+        cellStart.assign((size_t)games * (gridCells + 1), 0);
+        cellItems.assign(slots, 0);
+        vehCell.assign(slots, 0);
+        gridDirty.assign(games, 1);
+        occupancy.assign((size_t)games * occupancyRows * laneWords, 0);
+        spawnMasks.assign((size_t)games * SPAWN_MASKS * laneWords, 0);
+        vehOccupancyRow.assign(slots, 0);
+        occupancyDirty.assign(games, 1);
+        deriveTuning();
+        itemLaneCapacity = 1;
+        while (itemLaneCapacity < (int)std::ceil((params.roadHeight + ITEM_SPAWN_MARGIN) / params.itemRowSpacing) + 2) {
+            itemLaneCapacity *= 2;
+        }
+        itemY.assign((size_t)games * params.lanes * itemLaneCapacity, 0);
+        itemType.assign(itemY.size(), ITEM_TAKEN);
+        itemHead.assign((size_t)games * params.lanes, 0); itemCount.assign((size_t)games * params.lanes, 0);
+        itemRowPos.assign(games, 0);
+        itemScroll.assign(games, 0);
+        itemLive.assign(games, 0);
+        itemRng.assign(games, Rng());
+        nitroActive.assign(games, 0); shieldActive.assign(games, 0);
+        nitroTimer.assign(games, TimerHandle()); shieldTimer.assign(games, TimerHandle());
+        effectTimers.assign(games, TimerWheel());
+
+        for (int g = 0; g < games; ++g) reset(g);
+    }
+
+    int slotBegin(int g) const { return g * capacity; }
+    int slotEnd(int g) const { return g * capacity + trafficCount[g]; }
+    Scalar playerY() const { return playerYS; }
+    Scalar laneWidth() const { return laneWidthS; }
+    Scalar laneX(int lane, Scalar width) const { return laneWidthS * lane + laneWidthS / 2 - width / 2; }
+
+    // Items: ring of (game, lane), and the storage slot of its k-th oldest item
+    int itemRing(int g, int lane) const { return g * params.lanes + lane; }
+    Scalar itemYAt(int g, int slot) const { return itemY[slot] + itemScroll[g]; }
+    int itemRingSlot(int ring, int k) const {
+        return ring * itemLaneCapacity + ((itemHead[ring] + k) & (itemLaneCapacity - 1));
+    }
+    Scalar topSpeed(int g) const {
+        return nitroActive[g] ? Scalar(params.playerMaxSpeed) * Scalar(params.nitroSpeedMultiplier)
+                                  : Scalar(params.playerMaxSpeed);
+    }
+
+    // Grid coordinates; clamped, so everything above or below the road lands in the edge rows
+    int gridColumn(Scalar centerX) const {
+        return std::max(0, std::min(params.lanes - 1, toInt(centerX * invLaneWidthS)));
+    }
+    int gridRow(Scalar y) const {
+        return std::max(0, std::min(gridRows - 1, toInt(y * invCellHeightS) + 1));
+    }
+
+    // Bring game g's grid up to date with the current positions (call before visitArea/visitCells)
+    void updateGrid(int g) {
+        if (gridDirty[g]) buildGrid(g);
+    }
+
+    // Occupancy row of a top edge; clamped like gridRow
+    int occupancyRow(Scalar y) const {
+        return std::max(0, std::min(occupancyRows - 1, toInt((y + occupancyTopS) * invRowHeightS)));
+    }
+
+    // Bring game g's bitboard up to date (call before occupiedLanes)
+    void updateOccupancy(int g) {
+        if (occupancyDirty[g]) buildOccupancy(g);
+    }
+
+    // Lanes holding a vehicle whose top edge may lie in [y0, y1], into mask (laneWords words).
+    // Conservative by up to one row at each end
+    void occupiedLanes(int g, Scalar y0, Scalar y1, uint64_t* mask) const {
+        const uint64_t* rows = &occupancy[(size_t)g * occupancyRows * laneWords];
+        std::fill(mask, mask + laneWords, 0ull);
+        for (int r = occupancyRow(y0), last = occupancyRow(y1); r <= last; ++r) {
+            for (int w = 0; w < laneWords; ++w) mask[w] |= rows[(size_t)r * laneWords + w];
+        }
+    }
+
+    // Call visit(slot) for every vehicle of game g in lane columns [laneLo, laneHi] and rows
+    // [rowLo, rowHi] until it returns true. Candidates only: callers do the exact test.
+    template <typename Visit>
+    bool visitCells(int g, int laneLo, int laneHi, int rowLo, int rowHi, Visit visit) const {
+        const int* start = &cellStart[(size_t)g * (gridCells + 1)];
+        const int* items = &cellItems[slotBegin(g)];
+        for (int lane = laneLo; lane <= laneHi; ++lane) {
+            int first = start[lane * gridRows + rowLo], last = start[lane * gridRows + rowHi + 1];
+            for (int k = first; k < last; ++k) {
+                if (visit(items[k])) return true;
+            }
+        }
+        return false;
+    }
+
+    // Vehicles whose top edge may lie in [y0, y1] and whose center may lie in [x0, x1]
+    template <typename Visit>
+    bool visitArea(int g, Scalar x0, Scalar x1, Scalar y0, Scalar y1, Visit visit) const {
+        return visitCells(g, gridColumn(x0), gridColumn(x1), gridRow(y0), gridRow(y1), visit);
+    }
+
+    // Hand game g's chunk generation to `supplier` (null to generate on the sim thread again)
+    void setChunkSupplier(int g, ChunkSupplier* supplier) {
+        chunkSuppliers[g] = supplier;
+        if (supplier) supplier->restart(chunkSeed[g]);
+    }
+
+    // Swap in new tuning between ticks (config hot reload). Fields that size the World's arrays or
+    // place the player and the chunk grid keep their construction values; chunks already laid
+    // out finish with the old tuning
+    void setTuning(const Params& p) {
+        Params tuned = p;
+        tuned.lanes = params.lanes;
+        tuned.roadWidth = params.roadWidth;
+        tuned.roadHeight = params.roadHeight;
+        tuned.playerOffsetY = params.playerOffsetY;
+        tuned.itemRowSpacing = params.itemRowSpacing;
+        tuned.chunkLength = params.chunkLength;
+        params = tuned;
+        deriveTuning();
+        for (int g = 0; g < games; ++g) {
+            if (chunkSuppliers[g]) chunkSuppliers[g]->retune(params, chunkSeed[g], chunkIndex[g] + 1);
+        }
+    }
+
+    // Share tables already built for params.trafficMix (e.g. from an EnvTableCache) instead of
+    // the World's own copy. Tables for another mix are refused
+    bool useSpawnTables(std::shared_ptr<const SpawnTables> tables) {
+        if (!tables || !tables->builtFor(params.trafficMix)) return false;
+        spawnTables = std::move(tables);
+        return true;
+    }
+
+    // Run the traffic phases of large games on `executor` (null for single-threaded). Only useful
+    // when one game is stepped at a time; the batch env parallelizes across games instead
+    void setParallelFor(ParallelFor* executor) {
+        parallel = executor;
+    }
+
+    // Start a new episode from a fresh seed, so the episode can be replayed from (seed, inputs)
+    void reset(int g, uint64_t seed) {
+        rng[g].reseed(seed);
+        reset(g);
+    }
+
+    // Start a new episode for game g (the game's RNG keeps running, so episodes differ)
+    void reset(int g) {
+        playerLane[g] = playerTargetLane[g] = params.playerStartLane;
+        playerChangingLane[g] = 0;
+        playerSpeed[g] = 0;
+        playerX[g] = laneX(playerLane[g], params.playerWidth);
+        crashed[g] = 0;
+        score[g] = 0;
+        distance[g] = 0;
+        maxSpeed[g] = 0;
+        level[g] = 1;
+        roadSpeed[g] = params.baseRoadSpeed;
+        spawnRate[g] = trafficSpawnRate(g);
+        chunkSeed[g] = rng[g].next();
+        chunkIndex[g] = 0;
+        chunkPos[g] = 0;
+        chunkCursor[g] = 0;
+        chunks[(size_t)g * 2].index = chunks[(size_t)g * 2 + 1].index = -1;
+        if (chunkSuppliers[g]) chunkSuppliers[g]->restart(chunkSeed[g]);
+        ticks[g] = 0;
+        resetItems(g);
+        trafficCount[g] = 0;
+
+        // Seed initial traffic: ensure each non-player lane has at least one vehicle ahead,
+        // then spread any further seeded vehicles evenly down the road
+        const int perLane = std::max(1, params.initialVehiclesPerLane);
+        const float spacing = params.roadHeight / perLane;
+        for (int lane = 0; lane < params.lanes; ++lane) {
+            if (lane == playerLane[g]) continue;
+            // Stagger repeats every 8 lanes so wide roads don't seed vehicles far above the screen
+            int type = randomVehicleType(g);
+            Scalar spawnY = -Scalar(VEHICLE_SPECS[type].height) - randomRange(g, 50.0f, 400.0f) - (lane % 8) * 80;
+            addVehicle(g, type, lane, spawnY);
+            for (int k = 1; k < perLane; ++k) {
+                addVehicle(g, randomVehicleType(g), lane, Scalar(spacing * (k - 1)) + randomRange(g, 0.0f, spacing * 0.25f));
+            }
+        }
+        gridDirty[g] = 1;
+        occupancyDirty[g] = 1;
+    }
+
+    // Advance game g by one tick with the given held input
+    StepResult step(int g, uint32_t input) {
+        StepResult result = { 0.0f, EVENT_NONE };
+        if (crashed[g]) return result;
+        Scalar scoreBefore = score[g];
+        ticks[g]++;
+
+        // Effects that run out this tick
+        effectTimers[g].advance([&](uint32_t effect) { endEffect(g, effect); });
+
+        // Lane changing
+        if (input & INPUT_LEFT) changeLane(g, -1);
+        if (input & INPUT_RIGHT) changeLane(g, 1);
+
+        // Acceleration and braking
+        Scalar speed = playerSpeed[g];
+        if (input & INPUT_ACCELERATE) speed += accelerateStepS;
+        else if (input & INPUT_BRAKE) speed -= brakeStepS;
+        else speed -= coastStepS;
+        playerSpeed[g] = std::max(Scalar(0), std::min(topSpeed(g), speed));
+        maxSpeed[g] = std::max(maxSpeed[g], playerSpeed[g]);
+
+        updatePlayerLane(g);
+
+        // Update road speed based on player speed
+        roadSpeed[g] = Scalar(params.baseRoadSpeed) + playerSpeed[g] * Scalar(0.5f);
+        spawnRate[g] = trafficSpawnRate(g);
+
+        // Update distance and score
+        distance[g] += (roadSpeed[g] + playerSpeed[g]) * Scalar(0.1f);
+        score[g] += playerSpeed[g] * Scalar(0.5f);
+
+        // Level progression
+        int newLevel = toInt(distance[g] / Scalar(params.distancePerLevel)) + 1;
+        if (newLevel > level[g]) {
+            level[g] = newLevel;
+            result.events |= EVENT_LEVEL_UP;
+        }
+
+        spawnItems(g);
+        if (updateItems(g)) result.events |= EVENT_ITEM;
+
+        spawnTraffic(g);
+
+        if (updateTraffic(g) && !shieldActive[g]) {
+            crashed[g] = 1;
+            result.events |= EVENT_CRASH;
+        }
+
+        result.reward = toFloat(score[g] - scoreBefore);
+        return result;
+    }
+
+private:
+    // Items spawn up to this far above the road, so rings must also hold that stretch
+    static constexpr float ITEM_SPAWN_MARGIN = 200.0f;
+    static constexpr float ITEM_REBASE_DISTANCE = 4096.0f;
+
+    // Timer wheel payloads
+    enum Effect : uint32_t {
+        EFFECT_NITRO_END = 0,
+        EFFECT_SHIELD_END
+    };
+
+    Scalar laneWidthS, playerYS;
+    Scalar itemRollBound[ITEM_TYPE_COUNT]; // a lane's item roll below bound t (and no earlier one) spawns type t
+    Scalar invLaneWidthS, invCellHeightS; // multiplies instead of divides when bucketing
+    Scalar invRowHeightS, occupancyTopS;
+    Scalar speedBucketScaleS; // player speed -> spawn table speed bucket
+    std::vector<uint64_t> allLanes; // bits of every lane on the road, laneWords words
+    int spawnLaneReach; // neighboring lane columns a spawn spacing check must include
+
+    Scalar lateralRateS; // lane-change progress per tick
+
+    // Player speed change per tick under each input, and the traffic speed factor, with the
+    // environment folded in
+    Scalar accelerateStepS, brakeStepS, coastStepS;
+    Scalar trafficSpeedScaleS;
+    std::shared_ptr<const SpawnTables> spawnTables; // built for params.trafficMix
+
+    // Constants that follow the tuning fields of params (see setTuning)
+    void deriveTuning() {
+        lateralRateS = Scalar(params.trafficLaneChangeSpeed) / laneWidthS;
+        accelerateStepS = Scalar(params.playerAcceleration) * Scalar(params.speedMultiplier) / Scalar(params.friction);
+        brakeStepS = Scalar(params.playerDeceleration) * 2 * Scalar(params.friction);
+        coastStepS = Scalar(params.playerDeceleration) * Scalar(0.5f) * Scalar(params.friction);
+        trafficSpeedScaleS = Scalar(params.speedMultiplier);
+        if (!spawnTables || !spawnTables->builtFor(params.trafficMix)) spawnTables = SpawnTables::forMix(params.trafficMix);
+        speedBucketScaleS = Scalar(SPAWN_SPEED_BUCKETS / params.playerMaxSpeed);
+        idm = IdmCoefficients(params);
+        itemRollBound[ITEM_POTHOLE] = params.obstacleDensity;
+        for (int t = ITEM_POTHOLE + 1; t < ITEM_TYPE_COUNT; ++t) {
+            itemRollBound[t] = itemRollBound[t - 1] + Scalar(params.powerupDensity * ITEM_SPECS[t].powerupShare);
+        }
+    }
+
+    // FSM output by lane-index position: IDM desired speed and maximum acceleration
+    std::vector<Scalar> rankDesired, rankAccel;
+
+    // IDM batch: per game EVAL_BLOCKS blocks of trafficCount entries, block b entry k being one
+    // (follower, leader) pairing around the vehicle at lane-index position k
+    enum EvalBlock {
+        EVAL_CURRENT = 0,        // vehicle behind its current leader
+        EVAL_LEFT_SELF,          // vehicle behind its would-be leader one lane left
+        EVAL_LEFT_NEW_FOLLOWER,  // would-be follower one lane left, behind the vehicle
+        EVAL_RIGHT_SELF,
+        EVAL_RIGHT_NEW_FOLLOWER,
+        EVAL_OLD_FOLLOWER,       // current follower behind the current leader once the vehicle leaves
+        EVAL_BLOCKS
+    };
+    std::vector<Scalar> evalSpeed, evalDesired, evalMaxAccel, evalGap, evalLeaderSpeed, evalAccel;
+
+    // Counting sort of game g's vehicles into the lane grid
+    void buildGrid(int g) {
+        int* start = &cellStart[(size_t)g * (gridCells + 1)];
+        int* items = &cellItems[slotBegin(g)];
+        const int begin = slotBegin(g), end = slotEnd(g);
+        gridDirty[g] = 0;
+        std::fill(start, start + gridCells + 1, 0);
+        for (int i = begin; i < end; ++i) {
+            int cell = gridColumn(vehX[i] + vehWidth[i] / 2) * gridRows + gridRow(vehY[i]);
+            vehCell[i] = cell;
+            start[cell]++;
+        }
+        // Inclusive prefix sums give each cell's end; filling backwards leaves each cell's start
+        for (int c = 1; c <= gridCells; ++c) start[c] += start[c - 1];
+        for (int i = end - 1; i >= begin; --i) items[--start[vehCell[i]]] = i;
+    }
+
+    // Rebuild game g's bitboard: row indices in one branch-free pass, then one OR per vehicle
+    void buildOccupancy(int g) {
+        uint64_t* rows = &occupancy[(size_t)g * occupancyRows * laneWords];
+        const int begin = slotBegin(g), count = trafficCount[g];
+        const Scalar* __restrict y = &vehY[begin];
+        int* __restrict row = &vehOccupancyRow[begin];
+        occupancyDirty[g] = 0;
+        std::memset(rows, 0, sizeof(uint64_t) * occupancyRows * laneWords);
+        for (int k = 0; k < count; ++k) row[k] = occupancyRow(y[k]);
+        for (int k = 0; k < count; ++k) setLane(rows + (size_t)row[k] * laneWords, gridColumn(vehX[begin + k] + vehWidth[begin + k] / 2));
+    }
+
+    // Lane masks are arrays of laneWords words, lane l being bit l % 64 of word l / 64
+    static void setLane(uint64_t* mask, int lane) {
+        mask[lane >> 6] |= 1ull << (lane & 63);
+    }
+
+    static bool hasLane(const uint64_t* mask, int lane) {
+        return (mask[lane >> 6] >> (lane & 63)) & 1;
+    }
+
+    int laneCount(const uint64_t* mask) const {
+        int n = 0;
+        for (int w = 0; w < laneWords; ++w) n += bitCount(mask[w]);
+        return n;
+    }
+
+    // Lowest lane in mask, or -1
+    int firstLane(const uint64_t* mask) const {
+        for (int w = 0; w < laneWords; ++w) {
+            if (mask[w]) return w * 64 + lowestBit(mask[w]);
+        }
+        return -1;
+    }
+
+    // Uniform value in [min, max); computed in Scalar so fixed-point builds never touch float math
+    Scalar randomRange(int g, float min, float max) {
+        return Scalar(min) + Scalar(rng[g].nextFloat()) * (Scalar(max) - Scalar(min));
+    }
+
+    // O(1) draw from the alias table of the game's level and player speed bucket
+    int randomVehicleType(int g) {
+        return vehicleTypeFor(g, rng[g].next());
+    }
+
+    int vehicleTypeFor(int g, uint64_t draw) const {
+        int speedBucket = std::min(SPAWN_SPEED_BUCKETS - 1, toInt(playerSpeed[g] * speedBucketScaleS));
+        return spawnTables->lookup(level[g], speedBucket).sample(draw);
+    }
+
+    Scalar getTrafficDensity(int g) const {
+        return std::min(Scalar(params.maxSpawnRate), Scalar(params.baseSpawnRate) + Scalar(params.spawnRateIncrease) * level[g]
+                                                         + distance[g] / Scalar(params.distancePerSpawnRate));
+    }
+
+    // Density thinned by player speed, like game.js spawnMultiplier
+    Scalar trafficSpawnRate(int g) const {
+        Scalar speedNorm = std::min(Scalar(1), playerSpeed[g] / Scalar(params.playerMaxSpeed));
+        Scalar multiplier = Scalar(params.spawnSlowMultiplier) - Scalar(params.spawnSpeedThinning) * speedNorm * speedNorm;
+        return std::max(Scalar(params.minSpawnRate), getTrafficDensity(g) * multiplier);
+    }
+
+    bool addVehicle(int g, int type, int lane, Scalar y) {
+        if (trafficCount[g] >= capacity) return false;
+        const VehicleSpec& spec = VEHICLE_SPECS[type];
+        Rng& r = rng[g];
+        int i = slotEnd(g);
+        vehType[i] = type;
+        vehWidth[i] = spec.width;
+        vehHeight[i] = spec.height;
+        vehSpeed[i] = (Scalar(spec.baseSpeed) + (Scalar(r.nextFloat()) - Scalar(0.5f)) * Scalar(spec.speedVariation)) * trafficSpeedScaleS;
+        vehPoints[i] = spec.points;
+        vehLane[i] = lane;
+        vehX[i] = laneX(lane, spec.width);
+        vehY[i] = y;
+        vehOscillation[i] = randomRange(g, 0.0f, 2 * PI);
+        vehOscillationSpeed[i] = randomRange(g, 0.01f, 0.03f);
+        vehReactionTime[i] = randomRange(g, 0.2f, 0.7f); // seconds-ish reaction time modifier
+        vehBaseSpeed[i] = vehSpeed[i];
+        vehAggression[i] = randomRange(g, 0.2f, 1.0f);
+        vehTargetLane[i] = lane;
+        vehAiState[i] = AI_CRUISE;
+        vehChangingLane[i] = 0;
+        vehLateralShift[i] = 0;
+        vehLateralProgress[i] = 0;
+        trafficCount[g]++;
+        return true;
+    }
+
+    // Swap-remove so the game's slots stay dense
+    void removeVehicle(int g, int i) {
+        int last = slotEnd(g) - 1;
+        if (i != last) {
+            vehX[i] = vehX[last]; vehY[i] = vehY[last];
+            vehWidth[i] = vehWidth[last]; vehHeight[i] = vehHeight[last];
+            vehSpeed[i] = vehSpeed[last];
+            vehOscillation[i] = vehOscillation[last]; vehOscillationSpeed[i] = vehOscillationSpeed[last];
+            vehReactionTime[i] = vehReactionTime[last];
+            vehLane[i] = vehLane[last]; vehPoints[i] = vehPoints[last]; vehType[i] = vehType[last];
+            vehBaseSpeed[i] = vehBaseSpeed[last]; vehAggression[i] = vehAggression[last];
+            vehTargetLane[i] = vehTargetLane[last];
+            vehAiState[i] = vehAiState[last]; vehChangingLane[i] = vehChangingLane[last];
+            vehLateralShift[i] = vehLateralShift[last]; vehLateralProgress[i] = vehLateralProgress[last];
+        }
+        trafficCount[g]--;
+    }
+
+    void changeLane(int g, int direction) {
+        int newLane = playerLane[g] + direction;
+        if (newLane >= 0 && newLane < params.lanes && !playerChangingLane[g]) {
+            playerTargetLane[g] = newLane;
+            playerChangingLane[g] = 1;
+        }
+    }
+
+    void updatePlayerLane(int g) {
+        if (!playerChangingLane[g]) return;
+        Scalar targetX = laneX(playerTargetLane[g], params.playerWidth);
+        Scalar diff = targetX - playerX[g];
+        Scalar move = std::min(scalarAbs(diff), Scalar(params.laneChangeSpeed));
+        if (scalarAbs(diff) <= move) {
+            playerX[g] = targetX;
+            playerLane[g] = playerTargetLane[g];
+            playerChangingLane[g] = 0;
+        } else {
+            playerX[g] += (diff > Scalar(0) ? move : -move);
+        }
+    }
+
+    // Items per parallel piece; games below twice this run every phase inline
+    static const int PARALLEL_GRAIN = 1024;
+
+    template <typename Body>
+    void forRange(int count, int grain, Body body) {
+        if (parallel && count >= 2 * grain) parallel->run(count, grain, body);
+        else body(0, count);
+    }
+
+    // Random lane in [0, count) from the game's RNG, integer-only so fixed-point builds stay exact
+    int randomIndex(int g, int count) {
+        return (int)(((rng[g].next() >> 32) * (uint64_t)count) >> 32);
+    }
+
+    // Lanes whose topmost vehicle is farthest from the player, from the first occupied row of each
+    // lane; the lowest such lane wins ties. Lanes with no traffic at all come first.
+    // `unseen` is scratch of laneWords words.
+    int laneWithLargestGap(int g, const uint64_t* candidates, uint64_t* unseen) const {
+        const uint64_t* rows = &occupancy[(size_t)g * occupancyRows * laneWords];
+        std::copy(candidates, candidates + laneWords, unseen);
+        for (int r = 0; r < occupancyRows; ++r) {
+            const uint64_t* row = rows + (size_t)r * laneWords;
+            bool left = false, cleared = true;
+            for (int w = 0; w < laneWords; ++w) {
+                left |= unseen[w] != 0;
+                cleared &= (unseen[w] & ~row[w]) == 0;
+            }
+            if (!left) return -1;
+            if (cleared) return firstLane(unseen);
+            for (int w = 0; w < laneWords; ++w) unseen[w] &= ~row[w];
+        }
+        return firstLane(unseen);
+    }
+
+    // Index of the n-th set lane of mask (n < laneCount)
+    int nthLane(const uint64_t* mask, int n) const {
+        for (int w = 0; w < laneWords; ++w) {
+            uint64_t bits = mask[w];
+            const int inWord = bitCount(bits);
+            if (n >= inWord) {
+                n -= inWord;
+                continue;
+            }
+            while (n-- > 0) bits &= bits - 1;
+            return w * 64 + lowestBit(bits);
+        }
+        return -1;
+    }
+
+    // Any of lanes [lane - reach, lane + reach] that exist on the road set in mask
+    bool anyLaneNear(const uint64_t* mask, int lane, int reach) const {
+        for (int l = std::max(0, lane - reach); l <= std::min(params.lanes - 1, lane + reach); ++l) {
+            if (hasLane(mask, l)) return true;
+        }
+        return false;
+    }
+
+    // Game g's buffer for chunk `index`: taken from the supplier or laid out on first use
+    TrafficChunk& chunkFor(int g, int64_t index) {
+        TrafficChunk& chunk = chunks[(size_t)g * 2 + (size_t)(index & 1)];
+        if (chunk.index == index && chunk.seed == chunkSeed[g]) return chunk;
+        ChunkSupplier* supplier = chunkSuppliers[g];
+        if (!supplier || !supplier->take(chunkSeed[g], index, chunk)) generateTrafficChunk(params, chunkSeed[g], index, chunk);
+        return chunk;
+    }
+
+    // Every query is a few bitboard words; vehicles spawned earlier in this tick are added to the
+    // bitboard as they are placed
+    void spawnEntry(int g, const ChunkEntry& e, Scalar y, const uint64_t* freeLanes, int freeCount,
+                    const uint64_t* candidates, uint64_t* scratch) {
+        int chosenLane = e.lane;
+        if (!hasLane(freeLanes, chosenLane)) {
+            if (freeCount) {
+                // Uniform choice among free lanes other than the player's (like game.js spawnTraffic)
+                chosenLane = nthLane(freeLanes, (int)(((uint64_t)e.laneRoll * (uint64_t)freeCount) >> 32));
+            } else {
+                // All lanes blocked: pick lane with largest gap (farthest nearest vehicle)
+                chosenLane = laneWithLargestGap(g, candidates, scratch);
+            }
+        }
+        if (chosenLane == -1) return;
+
+        int type = vehicleTypeFor(g, e.typeDraw);
+        Scalar spawnY = y - Scalar(VEHICLE_SPECS[type].height);
+        occupiedLanes(g, spawnY - Scalar(150), spawnY + Scalar(150), scratch);
+        if (anyLaneNear(scratch, chosenLane, spawnLaneReach)) return;
+        if (addVehicle(g, type, chosenLane, spawnY)) {
+            setLane(&occupancy[((size_t)g * occupancyRows + occupancyRow(spawnY)) * laneWords], chosenLane);
+        }
+    }
+
+    // Advance the spawn line by the road scroll and materialize the chunk entries it passed. The
+    // line sits SPAWN_LINE px above the screen; an entry passed d px ago spawns d px below it.
+    void spawnTraffic(int g) {
+        const Scalar SPAWN_LINE = 100;
+        const Scalar length = params.chunkLength;
+        chunkPos[g] += roadSpeed[g];
+
+        bool lanesKnown = false;
+        uint64_t* candidates = &spawnMasks[(size_t)g * SPAWN_MASKS * laneWords];
+        uint64_t* freeLanes = candidates + laneWords;
+        uint64_t* scratch = freeLanes + laneWords;
+        int freeCount = 0;
+        for (;;) {
+            TrafficChunk& chunk = chunkFor(g, chunkIndex[g]);
+            const int count = (int)chunk.entries.size();
+            const Scalar keepBelow = chunk.density > Scalar(0) ? spawnRate[g] / chunk.density : Scalar(0);
+            while (chunkCursor[g] < count && chunk.entries[chunkCursor[g]].offset <= chunkPos[g]) {
+                const ChunkEntry& e = chunk.entries[chunkCursor[g]++];
+                if (e.keep >= keepBelow) continue;
+                if (!lanesKnown) {
+                    // Lanes with a vehicle near the player are blocked for this tick's spawns
+                    updateOccupancy(g);
+                    const Scalar py = playerY();
+                    std::copy(allLanes.begin(), allLanes.end(), candidates);
+                    candidates[playerLane[g] >> 6] &= ~(1ull << (playerLane[g] & 63));
+                    occupiedLanes(g, py - Scalar(220), py + Scalar(50), scratch);
+                    for (int w = 0; w < laneWords; ++w) freeLanes[w] = candidates[w] & ~scratch[w];
+                    freeCount = laneCount(freeLanes);
+                    lanesKnown = true;
+                }
+                spawnEntry(g, e, chunkPos[g] - e.offset - SPAWN_LINE, freeLanes, freeCount, candidates, scratch);
+            }
+            if (chunkPos[g] < length) break;
+            // Crossed into the next chunk; its buffer takes over and the old one is reused two ahead
+            chunkIndex[g]++;
+            chunkPos[g] -= length;
+            chunkCursor[g] = 0;
+        }
+        if (lanesKnown) gridDirty[g] = 1;
+    }
+
+    // Counting sort of game g's slots by lane, then each lane sorted by y (ties by slot for determinism)
+    void buildLaneIndex(int g) {
+        int* start = &laneStart[(size_t)g * (params.lanes + 1)];
+        int* order = &laneOrder[slotBegin(g)];
+        const int begin = slotBegin(g), end = slotEnd(g);
+        std::fill(start, start + params.lanes + 1, 0);
+        for (int i = begin; i < end; ++i) start[vehLane[i]]++;
+        for (int lane = 1; lane <= params.lanes; ++lane) start[lane] += start[lane - 1];
+        for (int i = end - 1; i >= begin; --i) order[--start[vehLane[i]]] = i;
+        const int lanesPerPiece = std::max(1, params.lanes * PARALLEL_GRAIN / std::max(1, end - begin));
+        forRange(params.lanes, lanesPerPiece, [&](int laneBegin, int laneEnd) {
+            for (int lane = laneBegin; lane < laneEnd; ++lane) {
+                std::sort(order + start[lane], order + start[lane + 1], [&](int a, int b) {
+                    return vehY[a] < vehY[b] || (vehY[a] == vehY[b] && a < b);
+                });
+            }
+        });
+        forRange(end - begin, PARALLEL_GRAIN, [&](int kBegin, int kEnd) {
+            for (int k = kBegin; k < kEnd; ++k) laneRank[order[k]] = k;
+        });
+    }
+
+    // Sensing state for one lane adjacent to the lane being processed. Vehicles are visited in
+    // increasing y, so the cursor only ever moves forward.
+    struct LaneCursor {
+        int first, last, pos;
+
+        // Slots with the next larger y (leader) and the largest y not beyond `at` (follower)
+        void advance(const int* order, const std::vector<Scalar>& y, Scalar at, int& leader, int& follower) {
+            while (pos < last && y[order[pos]] <= at) ++pos;
+            leader = pos < last ? order[pos] : -1;
+            follower = pos > first ? order[pos - 1] : -1;
+        }
+    };
+
+    // Traffic AI for one tick, in batched phases over the lane index:
+    //   sense   - one walk records own and adjacent-lane neighbors and runs the FSM (desired speeds)
+    //   evaluate - IDM accelerations for current lanes and every candidate change in one kernel call
+    //   decide  - MOBIL incentive and safety per vehicle
+    //   move    - apply speeds, commit lane changes and glide sideways
+    // Every phase reads the same snapshot, so results don't depend on processing order.
+    void updateTrafficAI(int g) {
+        buildLaneIndex(g);
+        senseTraffic(g);
+        evaluateAccelerations(g);
+        chooseLanes(g);
+        moveTraffic(g);
+    }
+
+    // Lanes are sensed independently (in parallel when available). The OVERTAKE roll is the only
+    // random draw, so it is made afterwards in one pass in lane-index order, which keeps the RNG
+    // stream the same however the lanes were split.
+    void senseTraffic(int g) {
+        const int base = slotBegin(g), lanes = params.lanes, count = trafficCount[g];
+        const int* start = &laneStart[(size_t)g * (lanes + 1)];
+        const int* order = &laneOrder[base];
+        const Scalar maxAccel = params.idmMaxAcceleration;
+        const Scalar overtakeThreshold = 240; // larger distance to start considering an overtake
+        const Scalar py = playerY(), pSpeed = playerSpeed[g];
+
+        const int lanesPerPiece = std::max(1, lanes * PARALLEL_GRAIN / std::max(1, count));
+        forRange(lanes, lanesPerPiece, [&](int laneBegin, int laneEnd) {
+            for (int lane = laneBegin; lane < laneEnd; ++lane) {
+                const int first = start[lane], last = start[lane + 1];
+                LaneCursor left = { lane > 0 ? start[lane - 1] : 0, lane > 0 ? first : 0, 0 };
+                LaneCursor right = { lane + 1 < lanes ? last : 0, lane + 1 < lanes ? start[lane + 2] : 0, 0 };
+                left.pos = left.first;
+                right.pos = right.first;
+
+                for (int k = first; k < last; ++k) {
+                    const int i = order[k];
+                    const Scalar y = vehY[i];
+                    left.advance(order, vehY, y, nbLeftLeader[base + k], nbLeftFollower[base + k]);
+                    right.advance(order, vehY, y, nbRightLeader[base + k], nbRightFollower[base + k]);
+                    const int ahead = k + 1 < last ? order[k + 1] : -1;
+                    nbLeader[base + k] = ahead;
+                    nbFollower[base + k] = k > first ? order[k - 1] : -1;
+
+                    Scalar desired;
+                    bool playerApproaching = playerLane[g] == lane && py < y && (y - py) < Scalar(320) && pSpeed > vehSpeed[i] + Scalar(0.5f);
+                    if (playerApproaching) {
+                        // EVADE: ease off; the lane change itself is left to MOBIL with an extra bias
+                        Scalar urgency = std::max(Scalar(0), (Scalar(260) - (y - py)) / Scalar(260));
+                        Scalar reaction = std::min(Scalar(1), urgency / std::max(Scalar(0.05f), vehReactionTime[i]));
+                        desired = std::max(Scalar(0.6f), vehBaseSpeed[i] * (Scalar(1) - Scalar(0.45f) * reaction));
+                        vehAiState[i] = AI_EVADE;
+                    } else if (ahead >= 0 && vehY[ahead] - y < overtakeThreshold && vehSpeed[ahead] < vehSpeed[i] - Scalar(0.2f)) {
+                        // OVERTAKE candidate: push for more speed, which makes a free neighboring
+                        // lane attractive. Confirmed by the aggression roll below
+                        desired = std::min(vehSpeed[i] * Scalar(1.28f), vehSpeed[i] + Scalar(3));
+                        vehAiState[i] = AI_OVERTAKE;
+                    } else {
+                        desired = vehBaseSpeed[i];
+                        vehAiState[i] = AI_CRUISE;
+                    }
+
+                    // Overtakes accelerate twice as hard so they feel immediate
+                    rankDesired[base + k] = desired;
+                    rankAccel[base + k] = vehAiState[i] == AI_OVERTAKE ? maxAccel * 2 : maxAccel;
+                }
+            }
+        });
+
+        Rng& r = rng[g];
+        for (int k = 0; k < count; ++k) {
+            const int i = order[k];
+            if (vehAiState[i] != AI_OVERTAKE || Scalar(r.nextFloat()) < vehAggression[i]) continue;
+            vehAiState[i] = AI_CRUISE;
+            rankDesired[base + k] = vehBaseSpeed[i];
+            rankAccel[base + k] = maxAccel;
+        }
+    }
+
+    void evaluateAccelerations(int g) {
+        const int base = slotBegin(g), count = trafficCount[g];
+        const int* order = &laneOrder[base];
+        const size_t e0 = (size_t)base * EVAL_BLOCKS;
+        const Scalar openRoad = 1000000000;
+
+        // Follower f behind leader l (-1: open road, and no speed difference to close)
+        auto pair = [&](int block, int k, int f, int l) {
+            size_t e = e0 + (size_t)block * count + k;
+            int fk = base + laneRank[f];
+            evalSpeed[e] = vehSpeed[f];
+            evalDesired[e] = rankDesired[fk];
+            evalMaxAccel[e] = rankAccel[fk];
+            evalGap[e] = l < 0 ? openRoad : vehY[l] - vehY[f] - vehHeight[f];
+            evalLeaderSpeed[e] = l < 0 ? vehSpeed[f] : vehSpeed[l];
+        };
+
+        // The player is a virtual leader for traffic in line with it within the reaction distance,
+        // so cars brake for it through the same model they use for each other
+        const Scalar px = playerX[g], py = playerY();
+        const Scalar nearX = laneWidth() * Scalar(0.8f), reactionDistance = 220;
+        auto yieldToPlayer = [&](int k, int c) {
+            const Scalar gap = vehY[c] - py;
+            if (gap <= Scalar(-50) || gap >= reactionDistance || scalarAbs(vehX[c] - px) >= nearX) return;
+            size_t e = e0 + (size_t)EVAL_CURRENT * count + k;
+            if (gap >= evalGap[e]) return;
+            evalGap[e] = std::max(Scalar(0), gap);
+            evalLeaderSpeed[e] = vehSpeed[c];
+        };
+
+        // Missing followers get a placeholder pairing that chooseLanes never reads
+        forRange(count, PARALLEL_GRAIN, [&](int kBegin, int kEnd) {
+            for (int k = kBegin; k < kEnd; ++k) {
+                const int c = order[k], n = base + k;
+                pair(EVAL_CURRENT, k, c, nbLeader[n]);
+                yieldToPlayer(k, c);
+                pair(EVAL_LEFT_SELF, k, c, nbLeftLeader[n]);
+                pair(EVAL_LEFT_NEW_FOLLOWER, k, nbLeftFollower[n] >= 0 ? nbLeftFollower[n] : c, nbLeftFollower[n] >= 0 ? c : -1);
+                pair(EVAL_RIGHT_SELF, k, c, nbRightLeader[n]);
+                pair(EVAL_RIGHT_NEW_FOLLOWER, k, nbRightFollower[n] >= 0 ? nbRightFollower[n] : c, nbRightFollower[n] >= 0 ? c : -1);
+                pair(EVAL_OLD_FOLLOWER, k, nbFollower[n] >= 0 ? nbFollower[n] : c, nbFollower[n] >= 0 ? nbLeader[n] : -1);
+            }
+        });
+
+        forRange(count * EVAL_BLOCKS, PARALLEL_GRAIN * EVAL_BLOCKS, [&](int eBegin, int eEnd) {
+            const size_t e = e0 + eBegin;
+            idmAccelerationSpan(&evalAccel[e], &evalSpeed[e], &evalDesired[e], &evalMaxAccel[e],
+                                &evalGap[e], &evalLeaderSpeed[e], eEnd - eBegin, idm);
+        });
+    }
+
+    // MOBIL: change lanes when own gain plus politeness-weighted gain of the old and new followers
+    // beats the threshold, and the new follower stays above the safe deceleration. Left moves are
+    // only considered on even ticks and right moves on odd ones, so two cars never merge into the
+    // same gap from opposite sides in one batched step.
+    void chooseLanes(int g) {
+        const int base = slotBegin(g), count = trafficCount[g];
+        const int* order = &laneOrder[base];
+        const Scalar* accel = &evalAccel[(size_t)base * EVAL_BLOCKS];
+        auto A = [&](int block, int k) { return accel[(size_t)block * count + k]; };
+
+        const int side = (ticks[g] & 1) == 0 ? -1 : 1;
+        const int selfBlock = side < 0 ? EVAL_LEFT_SELF : EVAL_RIGHT_SELF;
+        const int newFollowerBlock = side < 0 ? EVAL_LEFT_NEW_FOLLOWER : EVAL_RIGHT_NEW_FOLLOWER;
+        const std::vector<int>& newLeaders = side < 0 ? nbLeftLeader : nbRightLeader;
+        const std::vector<int>& newFollowers = side < 0 ? nbLeftFollower : nbRightFollower;
+        const Scalar minGap = params.idmMinGap, safeDecel = params.mobilSafeDeceleration;
+        const Scalar threshold = params.mobilThreshold, evadeBias = params.mobilEvadeBias;
+        const Scalar py = playerY(), ph = params.playerHeight;
+        const Scalar glideTicks = Scalar(1) / lateralRateS;
+
+        forRange(count, PARALLEL_GRAIN, [&](int kBegin, int kEnd) {
+            for (int k = kBegin; k < kEnd; ++k) {
+                const int c = order[k], n = base + k;
+                const int to = vehLane[c] + side;
+                vehTargetLane[c] = vehLane[c];
+                if (vehChangingLane[c] || to < 0 || to >= params.lanes) continue;
+
+                // Room to merge without touching the new leader or follower
+                const Scalar y = vehY[c];
+                const int newLeader = newLeaders[n], newFollower = newFollowers[n], oldFollower = nbFollower[n];
+                if (newLeader >= 0 && vehY[newLeader] - (y + vehHeight[c]) < minGap) continue;
+                if (newFollower >= 0 && y - (vehY[newFollower] + vehHeight[newFollower]) < minGap) continue;
+
+                // The player holds its row on screen while traffic streams past, so a lane shared
+                // with the player is only safe if the vehicle won't reach it before the glide ends
+                bool playerThere = to == playerLane[g] || to == playerTargetLane[g];
+                bool reachesPlayer = y < py + ph && y + vehHeight[c] + (vehSpeed[c] + roadSpeed[g]) * glideTicks > py - minGap;
+                if (playerThere && reachesPlayer) continue;
+
+                Scalar newFollowerAfter = newFollower >= 0 ? A(newFollowerBlock, k) : Scalar(0);
+                if (newFollowerAfter < -safeDecel) continue;
+                Scalar newFollowerGain = newFollower >= 0 ? newFollowerAfter - A(EVAL_CURRENT, laneRank[newFollower]) : Scalar(0);
+                Scalar oldFollowerGain = oldFollower >= 0 ? A(EVAL_OLD_FOLLOWER, k) - A(EVAL_CURRENT, laneRank[oldFollower]) : Scalar(0);
+                Scalar politeness = Scalar(1) - vehAggression[c];
+                Scalar incentive = A(selfBlock, k) - A(EVAL_CURRENT, k) + politeness * (newFollowerGain + oldFollowerGain);
+                if (vehAiState[c] == AI_EVADE) incentive += evadeBias;
+                if (incentive > threshold) vehTargetLane[c] = to;
+            }
+        });
+    }
+
+    // Smoothstep easing for lateral moves: starts and ends with zero sideways speed
+    static Scalar easeLaneChange(Scalar t) {
+        return t * t * (Scalar(3) - Scalar(2) * t);
+    }
+
+    void moveTraffic(int g) {
+        const int base = slotBegin(g), count = trafficCount[g];
+        const int* order = &laneOrder[base];
+        const Scalar* accel = &evalAccel[(size_t)base * EVAL_BLOCKS]; // EVAL_CURRENT block
+        const Scalar maxDecel = params.idmMaxDeceleration;
+        forRange(count, PARALLEL_GRAIN, [&](int kBegin, int kEnd) {
+            for (int k = kBegin; k < kEnd; ++k) {
+                int i = order[k];
+                vehSpeed[i] = std::max(Scalar(0), vehSpeed[i] + std::max(-maxDecel, accel[k]));
+            }
+        });
+
+        // Commit lane changes and glide toward the new lane center. Moves are applied as eased
+        // increments so they add to the lateral oscillation instead of overriding it
+        forRange(count, PARALLEL_GRAIN, [&](int sBegin, int sEnd) {
+            for (int i = base + sBegin; i < base + sEnd; ++i) {
+                if (vehTargetLane[i] != vehLane[i]) {
+                    vehLateralShift[i] = laneX(vehTargetLane[i], vehWidth[i]) - vehX[i];
+                    vehLateralProgress[i] = 0;
+                    vehLane[i] = vehTargetLane[i];
+                    vehChangingLane[i] = 1;
+                }
+                if (!vehChangingLane[i]) continue;
+                Scalar from = vehLateralProgress[i];
+                Scalar to = std::min(Scalar(1), from + lateralRateS);
+                vehX[i] += vehLateralShift[i] * (easeLaneChange(to) - easeLaneChange(from));
+                vehLateralProgress[i] = to;
+                if (to >= Scalar(1)) vehChangingLane[i] = 0;
+            }
+        });
+    }
+
+    void resetItems(int g) {
+        for (int lane = 0; lane < params.lanes; ++lane) {
+            itemHead[itemRing(g, lane)] = 0;
+            itemCount[itemRing(g, lane)] = 0;
+        }
+        itemRowPos[g] = 0;
+        itemScroll[g] = 0;
+        itemLive[g] = 0;
+        itemRng[g].reseed(chunkSeed[g] ^ 0x6974656d73ull); // "items"
+        nitroActive[g] = shieldActive[g] = 0;
+        nitroTimer[g] = shieldTimer[g] = TimerHandle();
+        effectTimers[g].clear(0);
+    }
+
+    // Roll one row of items per itemRowSpacing px of item travel, just above the road. With both
+    // densities at zero no lane could roll anything, so rows are skipped without drawing
+    void spawnItems(int g) {
+        const Scalar spacing = params.itemRowSpacing;
+        const bool none = itemRollBound[ITEM_TYPE_COUNT - 1] <= Scalar(0);
+        itemRowPos[g] += roadSpeed[g] + Scalar(params.itemDrift);
+        while (itemRowPos[g] >= spacing) {
+            itemRowPos[g] -= spacing;
+            for (int lane = 0; lane < params.lanes && !none; ++lane) {
+                Scalar roll = Scalar(itemRng[g].nextFloat());
+                if (roll >= itemRollBound[ITEM_TYPE_COUNT - 1]) continue;
+                int type = 0;
+                while (roll >= itemRollBound[type]) type++;
+                addItem(g, type, lane, -Scalar(ITEM_SPECS[type].height) - itemRowPos[g]);
+            }
+        }
+    }
+
+    bool addItem(int g, int type, int lane, Scalar y) {
+        const int ring = itemRing(g, lane);
+        if (itemCount[ring] >= itemLaneCapacity) return false;
+        int slot = itemRingSlot(ring, itemCount[ring]++);
+        itemLive[g]++;
+        itemY[slot] = y - itemScroll[g];
+        itemType[slot] = (uint8_t)type;
+        return true;
+    }
+
+    // Move items, drop the ones past the bottom edge and pick up what the player touches.
+    // Returns true if anything was picked up
+    bool updateItems(int g) {
+        if (itemLive[g] == 0) return false;
+        itemScroll[g] += roadSpeed[g] + Scalar(params.itemDrift);
+        if (itemScroll[g] >= Scalar(ITEM_REBASE_DISTANCE)) rebaseItems(g);
+        // Only the oldest item of a lane can be the first past the bottom edge
+        const Scalar offScreenY = Scalar(params.roadHeight) + Scalar(50) - itemScroll[g];
+        for (int lane = 0; lane < params.lanes; ++lane) {
+            const int ring = itemRing(g, lane);
+            while (itemCount[ring] > 0 && itemY[itemRingSlot(ring, 0)] > offScreenY) {
+                itemHead[ring] = (itemHead[ring] + 1) & (itemLaneCapacity - 1);
+                itemCount[ring]--;
+                itemLive[g]--;
+            }
+        }
+
+        // Only the lanes under the player can touch it; within a lane, walk up from the oldest
+        // item until one is entirely above the player
+        const Scalar px = playerX[g], py = playerY();
+        const Scalar pw = params.playerWidth, ph = params.playerHeight;
+        const int laneLo = gridColumn(px), laneHi = gridColumn(px + pw);
+        bool picked = false;
+        for (int lane = laneLo; lane <= laneHi; ++lane) {
+            const int ring = itemRing(g, lane);
+            for (int k = 0; k < itemCount[ring]; ++k) {
+                const int slot = itemRingSlot(ring, k);
+                if (itemType[slot] == ITEM_TAKEN) continue;
+                const ItemSpec& spec = ITEM_SPECS[itemType[slot]];
+                const Scalar y = itemYAt(g, slot);
+                if (y + Scalar(spec.height) < py) break;
+                if (!overlaps(px, py, pw, ph, laneX(lane, spec.width), y, spec.width, spec.height)) continue;
+                applyItem(g, itemType[slot]);
+                itemType[slot] = ITEM_TAKEN;
+                picked = true;
+            }
+        }
+        return picked;
+    }
+
+    // Fold the scroll into the stored positions before it grows large enough to cost float
+    // precision; every ITEM_REBASE_DISTANCE px of travel, so the per-item work is amortized away
+    void rebaseItems(int g) {
+        const Scalar scroll = itemScroll[g];
+        for (int lane = 0; lane < params.lanes; ++lane) {
+            const int ring = itemRing(g, lane);
+            for (int k = 0; k < itemCount[ring]; ++k) itemY[itemRingSlot(ring, k)] += scroll;
+        }
+        itemScroll[g] = 0;
+    }
+
+    void applyItem(int g, int type) {
+        const uint64_t now = effectTimers[g].currentTick();
+        score[g] += ITEM_SPECS[type].points;
+        if (type == ITEM_NITRO) {
+            effectTimers[g].cancel(nitroTimer[g]);
+            nitroTimer[g] = effectTimers[g].schedule(now + params.nitroTicks, EFFECT_NITRO_END);
+            nitroActive[g] = 1;
+        } else if (type == ITEM_SHIELD) {
+            effectTimers[g].cancel(shieldTimer[g]);
+            shieldTimer[g] = effectTimers[g].schedule(now + params.shieldTicks, EFFECT_SHIELD_END);
+            shieldActive[g] = 1;
+        } else if (type == ITEM_POTHOLE && !shieldActive[g]) {
+            playerSpeed[g] = playerSpeed[g] * Scalar(params.potholeSpeedFactor);
+        }
+    }
+
+    void endEffect(int g, uint32_t effect) {
+        if (effect == EFFECT_NITRO_END) nitroActive[g] = 0;
+        else if (effect == EFFECT_SHIELD_END) shieldActive[g] = 0;
+    }
+
+    // Returns true if the player crashed
+    bool updateTraffic(int g) {
+        const int begin = slotBegin(g);
+        const Scalar px = playerX[g], py = playerY();
+        const Scalar offScreenY = Scalar(params.roadHeight) + Scalar(50);
+        const Scalar pw = params.playerWidth, ph = params.playerHeight;
+        updateTrafficAI(g);
+        forRange(trafficCount[g], PARALLEL_GRAIN, [&](int sBegin, int sEnd) {
+            const int i = begin + sBegin;
+            updateTrafficSpan(&vehX[i], &vehY[i], &vehSpeed[i], &vehOscillation[i], &vehOscillationSpeed[i],
+                              sEnd - sBegin, roadSpeed[g]);
+        });
+
+        // Remove vehicles that are off screen
+        for (int i = begin; i < slotEnd(g);) {
+            if (vehY[i] > offScreenY) {
+                score[g] += vehPoints[i];
+                removeVehicle(g, i);
+            } else {
+                ++i;
+            }
+        }
+
+        auto hitsPlayer = [&](int i) {
+            return overlaps(px, py, pw, ph, vehX[i], vehY[i], vehWidth[i], vehHeight[i]);
+        };
+        gridDirty[g] = 1;
+        occupancyDirty[g] = 1;
+        if (trafficCount[g] < GRID_MIN_TRAFFIC) {
+            for (int i = begin; i < slotEnd(g); ++i) {
+                if (hitsPlayer(i)) return true;
+            }
+            return false;
+        }
+
+        // Dense traffic: collision only needs the cells around the player
+        buildGrid(g);
+        const Scalar reachX = Scalar(MAX_VEHICLE_WIDTH) / 2;
+        return visitArea(g, px - reachX, px + pw + reachX, py - Scalar(MAX_VEHICLE_HEIGHT), py + ph, hitsPlayer);
+    }
+};
+
+} // namespace Sim
+
+#endif // HIGHWAY_SIM_H
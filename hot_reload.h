@@ -0,0 +1,239 @@
+// hot_reload.h
+// Live reload of the game's JSON files
+// A FileWatcher thread notices saves (inotify on Linux, mtime polling elsewhere) and runs the
+// file's parse callback there; the result is published through a SnapshotCell, which the sim
+// thread reads at a tick boundary with two atomic operations and no lock. No SFML dependency.
+
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#endif
+
+namespace Sim {
+
+// Read-copy-update cell holding the latest immutable snapshot of a T, for one writer thread and
+// one reader thread. The writer swaps the pointer and retires the old snapshot; it frees it once
+// the reader has passed a quiescent point (its next read()) after the swap.
+//
+//   writer:  cell.publish(std::unique_ptr<T>(new T(parsed)));
+//   reader:  uint64_t v = cell.version();
+//            if (v != seen) { seen = v; use(*cell.read()); }
+template <typename T>
+class SnapshotCell {
+private:
+    struct Retired {
+        const T* snapshot;
+        uint64_t readsAtRetire;
+    };
+
+    std::atomic<const T*> current;
+    std::atomic<uint64_t> reads{0};     // reader quiescent points so far
+    std::atomic<uint64_t> published{0};
+    std::vector<Retired> retired;       // writer only
+
+public:
+    explicit SnapshotCell(const T& initial) : current(new T(initial)) {}
+
+    // The writer must have stopped first
+    ~SnapshotCell() {
+        reclaim(~0ull);
+        delete current.load();
+    }
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    // Reader. Also declares that no pointer from an earlier read() is still in use, so the
+    // returned snapshot stays valid until the reader's next read()
+    const T* read() {
+        reads.fetch_add(1);
+        return current.load();
+    }
+
+    // Bumped by every publish. Compare versions rather than pointers to spot a new snapshot:
+    // a freed snapshot's address can come back. Reading it before read() can only cause an
+    // extra apply, never a missed one
+    uint64_t version() const { return published.load(); }
+
+    // Writer
+    void publish(std::unique_ptr<T> snapshot) {
+        const T* old = current.exchange(snapshot.release());
+        published.fetch_add(1);
+        retired.push_back(Retired{ old, reads.load() });
+        reclaim(reads.load());
+    }
+
+    // Writer: free retired snapshots the reader can no longer hold
+    void reclaim() { reclaim(reads.load()); }
+
+private:
+    void reclaim(uint64_t readsNow) {
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); ++i) {
+            if (readsNow > retired[i].readsAtRetire) delete retired[i].snapshot;
+            else retired[kept++] = retired[i];
+        }
+        retired.resize(kept);
+    }
+};
+
+// Calls a file's callback on the watcher thread shortly after the file is saved. Saves are
+// debounced, so an editor writing in several steps (or replacing the file by rename) triggers
+// one callback once the file has been quiet for `debounce`. Register files before start().
+class FileWatcher {
+private:
+    struct Entry {
+        std::string directory, name;
+        std::function<void()> onChange;
+        int descriptor = -1;
+        bool pending = false;
+        std::chrono::steady_clock::time_point lastEvent;
+#ifndef __linux__
+        std::filesystem::file_time_type lastWrite;
+#endif
+    };
+
+    std::vector<Entry> entries;
+    std::chrono::milliseconds debounce;
+    std::function<void()> idle;
+    std::thread thread;
+    std::atomic<bool> stopping{false};
+#ifdef __linux__
+    int notifyFd = -1;
+#endif
+
+    // Fire entries that have been quiet long enough
+    void flush() {
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].pending && now - entries[i].lastEvent >= debounce) {
+                entries[i].pending = false;
+                entries[i].onChange();
+            }
+        }
+        if (idle) idle();
+    }
+
+#ifdef __linux__
+    void run() {
+        alignas(struct inotify_event) char buffer[4096];
+        pollfd pfd = { notifyFd, POLLIN, 0 };
+        while (!stopping.load()) {
+            if (poll(&pfd, 1, (int)std::min<long long>(debounce.count(), 100)) > 0) {
+                ssize_t length = ::read(notifyFd, buffer, sizeof(buffer));
+                for (ssize_t at = 0; at < length;) {
+                    const inotify_event* event = (const inotify_event*)(buffer + at);
+                    at += (ssize_t)sizeof(inotify_event) + event->len;
+                    if (!event->len) continue;
+                    for (size_t i = 0; i < entries.size(); ++i) {
+                        if (entries[i].descriptor == event->wd && entries[i].name == event->name) {
+                            entries[i].pending = true;
+                            entries[i].lastEvent = std::chrono::steady_clock::now();
+                        }
+                    }
+                }
+            }
+            flush();
+        }
+    }
+#else
+    static std::filesystem::file_time_type writeTime(const Entry& e) {
+        std::error_code error;
+        auto t = std::filesystem::last_write_time(std::filesystem::path(e.directory) / e.name, error);
+        return error ? std::filesystem::file_time_type() : t;
+    }
+
+    void run() {
+        while (!stopping.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            for (size_t i = 0; i < entries.size(); ++i) {
+                auto t = writeTime(entries[i]);
+                if (t != entries[i].lastWrite) {
+                    entries[i].lastWrite = t;
+                    entries[i].pending = true;
+                    entries[i].lastEvent = std::chrono::steady_clock::now();
+                }
+            }
+            flush();
+        }
+    }
+#endif
+
+public:
+    explicit FileWatcher(std::chrono::milliseconds quietFor = std::chrono::milliseconds(50))
+        : debounce(quietFor) {}
+
+    ~FileWatcher() { stop(); }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    void watch(const std::string& path, std::function<void()> onChange) {
+        Entry e;
+        const size_t slash = path.find_last_of("/\\");
+        e.directory = slash == std::string::npos ? "." : path.substr(0, slash + 1);
+        e.name = slash == std::string::npos ? path : path.substr(slash + 1);
+        e.onChange = std::move(onChange);
+        entries.push_back(std::move(e));
+    }
+
+    // Called on the watcher thread after every wake-up (e.g. SnapshotCell::reclaim)
+    void onIdle(std::function<void()> callback) { idle = std::move(callback); }
+
+    // Returns false if the platform watch could not be set up (the game then just runs without
+    // reloads)
+    bool start() {
+        if (thread.joinable() || entries.empty()) return false;
+#ifdef __linux__
+        notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notifyFd < 0) return false;
+        // Watch directories rather than files: editors often save by writing a new file and
+        // renaming it over the old one, which would orphan a watch on the file itself
+        for (size_t i = 0; i < entries.size(); ++i) {
+            entries[i].descriptor = inotify_add_watch(notifyFd, entries[i].directory.c_str(),
+                                                      IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (entries[i].descriptor < 0) {
+                ::close(notifyFd);
+                notifyFd = -1;
+                return false;
+            }
+        }
+#else
+        for (size_t i = 0; i < entries.size(); ++i) entries[i].lastWrite = writeTime(entries[i]);
+#endif
+        stopping.store(false);
+        thread = std::thread([this] { run(); });
+        return true;
+    }
+
+    void stop() {
+        if (!thread.joinable()) return;
+        stopping.store(true);
+        thread.join();
+#ifdef __linux__
+        ::close(notifyFd);
+        notifyFd = -1;
+#endif
+    }
+};
+
+} // namespace Sim
+
+#endif // HOT_RELOAD_H
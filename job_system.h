@@ -0,0 +1,201 @@
+// job_system.h
+// Small job system: worker threads with per-thread deques and work stealing, a blocking
+// parallelFor the caller helps with, plus a lock-free single-producer/single-consumer ring for
+// handing results to the sim thread
+// Header-only; link with -pthread
+
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+
+// Bounded lock-free ring for exactly one producer thread and one consumer thread.
+// Capacity must be a power of two; one slot stays empty to tell full from empty.
+template <typename T, size_t Capacity>
+class SpscQueue {
+private:
+    static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    T items[Capacity];
+    alignas(64) std::atomic<size_t> head{0}; // next slot to read (consumer)
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to write (producer)
+
+public:
+    bool push(const T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t next = (t + 1) & (Capacity - 1);
+        if (next == head.load(std::memory_order_acquire)) return false;
+        items[t] = item;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Safe from either side; only a hint while the other side is active
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    // Look at the oldest item without removing it (consumer only)
+    bool peek(T& item) const {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = items[h];
+        return true;
+    }
+
+    bool pop(T& item) {
+        if (!peek(item)) return false;
+        head.store((head.load(std::memory_order_relaxed) + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+};
+
+// Fixed set of workers. A job submitted from a worker goes to that worker's own deque and is
+// taken back newest-first (it is likely still in cache); idle workers steal the oldest job from
+// the other deques. Jobs submitted from outside the pool are dealt round-robin.
+class JobPool {
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<int> queued{0};
+    std::atomic<unsigned> nextQueue{0};
+    bool stopping = false;
+
+    // Index of the pool worker running on this thread, -1 elsewhere
+    static int& currentWorker() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    bool popOwn(int w, std::function<void()>& job) {
+        WorkQueue& q = *queues[w];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.jobs.empty()) return false;
+        job = std::move(q.jobs.back());
+        q.jobs.pop_back();
+        return true;
+    }
+
+    bool takeOldest(int w, std::function<void()>& job) {
+        WorkQueue& q = *queues[w];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (q.jobs.empty()) return false;
+        job = std::move(q.jobs.front());
+        q.jobs.pop_front();
+        return true;
+    }
+
+    // Scan the other workers' deques, starting after the thief; a thief of -1 scans all of them
+    bool steal(int thief, std::function<void()>& job) {
+        const int n = (int)queues.size();
+        for (int k = 1; k < n + (thief < 0 ? 1 : 0); ++k) {
+            if (takeOldest((thief + k + n) % n, job)) return true;
+        }
+        return false;
+    }
+
+    void workerLoop(int w) {
+        currentWorker() = w;
+        std::function<void()> job;
+        for (;;) {
+            if (popOwn(w, job) || steal(w, job)) {
+                queued.fetch_sub(1);
+                job();
+                job = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepLock);
+            wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping) return;
+        }
+    }
+
+public:
+    explicit JobPool(int threadCount) {
+        threadCount = std::max(1, threadCount);
+        for (int i = 0; i < threadCount; ++i) queues.emplace_back(new WorkQueue());
+        for (int i = 0; i < threadCount; ++i) threads.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    // Queued jobs that haven't started are dropped
+    ~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    int size() const { return (int)threads.size(); }
+
+    void submit(std::function<void()> job) {
+        int w = currentWorker();
+        if (w < 0) w = (int)(nextQueue.fetch_add(1) % queues.size());
+        {
+            std::lock_guard<std::mutex> guard(queues[w]->lock);
+            queues[w]->jobs.push_back(std::move(job));
+        }
+        {
+            // Taken so a worker between its empty check and wait() can't miss the wakeup
+            std::lock_guard<std::mutex> lock(sleepLock);
+            queued.fetch_add(1);
+        }
+        wake.notify_one();
+    }
+
+    // Run one queued job on the calling thread, if there is one. Lets a thread that waits on
+    // jobs it submitted help out instead of blocking a core.
+    bool runOne() {
+        int w = currentWorker();
+        std::function<void()> job;
+        if (!(w >= 0 && popOwn(w, job)) && !steal(w, job)) return false;
+        queued.fetch_sub(1);
+        job();
+        return true;
+    }
+
+    // Split [0, count) into pieces of about `grain` items, run body(begin, end) on each and
+    // return when all are done. The caller runs pieces too, so this is safe to call from a job.
+    template <typename Body>
+    void parallelFor(int count, int grain, const Body& body) {
+        grain = std::max(1, grain);
+        const int pieces = std::min((count + grain - 1) / grain, 4 * (size() + 1));
+        if (pieces <= 1) {
+            if (count > 0) body(0, count);
+            return;
+        }
+        std::atomic<int> remaining{pieces};
+        auto piece = [&](int p) {
+            body((int)((int64_t)count * p / pieces), (int)((int64_t)count * (p + 1) / pieces));
+            remaining.fetch_sub(1, std::memory_order_release);
+        };
+        for (int p = 1; p < pieces; ++p) submit([&piece, p] { piece(p); });
+        piece(0);
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!runOne()) std::this_thread::yield();
+        }
+    }
+};
+
+} // namespace Sim
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,366 @@
+// json_reader.h
+// Minimal pull parser for the game's JSON files (config, environments)
+// Walks the text in place: callers ask for the shape they expect and get views into the buffer,
+// so nothing is allocated and no document tree is built. Header-only, no dependencies.
+
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace Json {
+
+// The four hex digits of a \u escape, starting at raw[at]
+inline bool readHex4(std::string_view raw, size_t at, unsigned& code) {
+    if (at + 4 > raw.size()) return false;
+    code = 0;
+    for (size_t k = at; k < at + 4; ++k) {
+        char h = raw[k];
+        code <<= 4;
+        if (h >= '0' && h <= '9') code |= (unsigned)(h - '0');
+        else if (h >= 'a' && h <= 'f') code |= (unsigned)(h - 'a' + 10);
+        else if (h >= 'A' && h <= 'F') code |= (unsigned)(h - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+// Decode the escapes of a raw string view (\uXXXX becomes UTF-8). A surrogate pair becomes one
+// four-byte character; a surrogate without its other half is an error.
+inline bool unescape(std::string_view raw, std::string& out) {
+    out.clear();
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++i == raw.size()) return false;
+        switch (raw[i]) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            unsigned code;
+            if (!readHex4(raw, i + 1, code)) return false;
+            i += 4;
+            if (code >= 0xDC00 && code <= 0xDFFF) return false;
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                unsigned low;
+                if (i + 2 >= raw.size() || raw[i + 1] != '\\' || raw[i + 2] != 'u' || !readHex4(raw, i + 3, low)
+                    || low < 0xDC00 || low > 0xDFFF) {
+                    return false;
+                }
+                i += 6;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            if (code < 0x80) {
+                out += (char)code;
+            } else if (code < 0x800) {
+                out += (char)(0xC0 | (code >> 6));
+                out += (char)(0x80 | (code & 0x3F));
+            } else if (code < 0x10000) {
+                out += (char)(0xE0 | (code >> 12));
+                out += (char)(0x80 | ((code >> 6) & 0x3F));
+                out += (char)(0x80 | (code & 0x3F));
+            } else {
+                out += (char)(0xF0 | (code >> 18));
+                out += (char)(0x80 | ((code >> 12) & 0x3F));
+                out += (char)(0x80 | ((code >> 6) & 0x3F));
+                out += (char)(0x80 | (code & 0x3F));
+            }
+            break;
+        }
+        default: return false;
+        }
+    }
+    return true;
+}
+
+// Reads one value at a time. Every call returns false once the reader has failed, so a loader
+// can run straight through and check ok() at the end.
+//
+//   reader.beginObject();
+//   while (reader.nextMember(key)) {
+//       if (key == "width") reader.readNumber(width);
+//       else reader.skipValue();
+//   }
+class Reader {
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+    const char* error = nullptr;
+    const char* errorAt = nullptr;
+    // Nothing read yet in the innermost open container. Closing any container clears it, which is
+    // right for the enclosing one too: the container was a value in it, so a comma comes next
+    bool first = false;
+
+    bool fail(const char* message) {
+        if (!error) {
+            error = message;
+            errorAt = p;
+        }
+        return false;
+    }
+
+    void skipSpace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+
+    bool literal(const char* word, size_t length) {
+        if ((size_t)(end - p) < length || std::string_view(p, length) != std::string_view(word, length)) {
+            return fail("invalid literal");
+        }
+        p += length;
+        return true;
+    }
+
+    // Comma handling shared by objects and arrays; false at the closing bracket
+    bool nextItem(char close) {
+        if (error) return false;
+        skipSpace();
+        if (p < end && *p == close) {
+            ++p;
+            first = false;
+            return false;
+        }
+        if (!first && !consume(',')) return fail("expected ',' or closing bracket");
+        first = false;
+        return true;
+    }
+
+public:
+    Reader(const char* text, size_t length) : begin(text), p(text), end(text + length) {}
+    explicit Reader(std::string_view text) : Reader(text.data(), text.size()) {}
+
+    bool ok() const { return !error; }
+    const char* errorMessage() const { return error ? error : ""; }
+    size_t errorOffset() const { return error ? (size_t)(errorAt - begin) : 0; }
+
+    // 1-based line of the error, for messages
+    int errorLine() const {
+        int line = 1;
+        for (const char* c = begin; c < errorAt; ++c) line += *c == '\n';
+        return line;
+    }
+
+    // Fail with the caller's message at the current position (schema errors)
+    bool reject(const char* message) { return fail(message); }
+
+    // True once only whitespace is left
+    bool atEnd() {
+        skipSpace();
+        return p == end;
+    }
+
+    enum Type { NONE, OBJECT, ARRAY, STRING, NUMBER, BOOL, NULL_VALUE };
+
+    Type peek() {
+        skipSpace();
+        if (error || p == end) return NONE;
+        switch (*p) {
+        case '{': return OBJECT;
+        case '[': return ARRAY;
+        case '"': return STRING;
+        case 't': case 'f': return BOOL;
+        case 'n': return NULL_VALUE;
+        default: return (*p == '-' || (*p >= '0' && *p <= '9')) ? NUMBER : NONE;
+        }
+    }
+
+    bool beginObject() {
+        if (error) return false;
+        if (!consume('{')) return fail("expected object");
+        first = true;
+        return true;
+    }
+
+    // Reads the next key and its ':'; false after the closing '}'
+    bool nextMember(std::string_view& key) {
+        if (!nextItem('}')) return false;
+        if (!readString(key)) return false;
+        if (!consume(':')) return fail("expected ':'");
+        return true;
+    }
+
+    bool beginArray() {
+        if (error) return false;
+        if (!consume('[')) return fail("expected array");
+        first = true;
+        return true;
+    }
+
+    // False after the closing ']'
+    bool nextElement() {
+        return nextItem(']');
+    }
+
+    // Decoded string contents, reusing `value`'s buffer
+    bool readString(std::string& value) {
+        std::string_view raw;
+        if (!readString(raw)) return false;
+        if (raw.find('\\') == std::string_view::npos) {
+            value.assign(raw.data(), raw.size());
+            return true;
+        }
+        return unescape(raw, value) || fail("invalid escape in string");
+    }
+
+    // Raw string contents between the quotes; escapes are left as written (see unescape)
+    bool readString(std::string_view& value) {
+        if (error) return false;
+        if (!consume('"')) return fail("expected string");
+        const char* start = p;
+        while (p < end && *p != '"') {
+            if (*p == '\\' && ++p == end) break;
+            if ((unsigned char)*p < 0x20) return fail("control character in string");
+            ++p;
+        }
+        if (p == end) return fail("unterminated string");
+        value = std::string_view(start, (size_t)(p - start));
+        ++p;
+        return true;
+    }
+
+    bool readBool(bool& value) {
+        if (peek() != BOOL) return fail("expected true or false");
+        value = *p == 't';
+        return value ? literal("true", 4) : literal("false", 5);
+    }
+
+    // Decimal digits with optional fraction and exponent; no leading zeros, as JSON requires. The
+    // result is correctly rounded while the digits fit in 2^53 and the exponent in 1e22, which
+    // covers every tuning value the game uses; beyond that it may be off in the last bit.
+    bool readNumber(double& value) {
+        if (peek() != NUMBER) return fail("expected number");
+        bool negative = *p == '-';
+        if (negative) ++p;
+        if (p == end || *p < '0' || *p > '9') return fail("invalid number");
+        if (*p == '0' && p + 1 < end && p[1] >= '0' && p[1] <= '9') return fail("leading zero in number");
+        uint64_t mantissa = 0;
+        int digits = 0, exponent = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+            if (digits < 19) mantissa = mantissa * 10 + (uint64_t)(*p - '0'), digits += mantissa > 0;
+            else exponent++;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            if (p == end || *p < '0' || *p > '9') return fail("invalid number");
+            for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+                if (digits < 19) mantissa = mantissa * 10 + (uint64_t)(*p - '0'), digits += mantissa > 0, exponent--;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            bool negativeExponent = p < end && *p == '-';
+            if (p < end && (*p == '-' || *p == '+')) ++p;
+            if (p == end || *p < '0' || *p > '9') return fail("invalid number");
+            int e = 0;
+            for (; p < end && *p >= '0' && *p <= '9'; ++p) e = std::min(100000, e * 10 + (*p - '0'));
+            exponent += negativeExponent ? -e : e;
+        }
+        static const double POWERS[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        double v = (double)mantissa;
+        if (exponent < 0 && exponent >= -22) v /= POWERS[-exponent];
+        else if (exponent > 0 && exponent <= 22) v *= POWERS[exponent];
+        else if (exponent != 0) v *= std::pow(10.0, exponent);
+        value = negative ? -v : v;
+        return true;
+    }
+
+    bool readNumber(float& value) {
+        double v;
+        if (!readNumber(v)) return false;
+        value = (float)v;
+        return true;
+    }
+
+    bool readNumber(int& value) {
+        double v;
+        if (!readNumber(v)) return false;
+        if (v != std::floor(v) || v < -2147483648.0 || v > 2147483647.0) return fail("expected integer");
+        value = (int)v;
+        return true;
+    }
+
+    // Skip one value of any type, nested containers included
+    bool skipValue() {
+        std::string_view ignoredString;
+        double ignoredNumber;
+        bool ignoredBool;
+        switch (peek()) {
+        case OBJECT: {
+            beginObject();
+            std::string_view key;
+            while (nextMember(key)) skipValue();
+            return ok();
+        }
+        case ARRAY:
+            beginArray();
+            while (nextElement()) skipValue();
+            return ok();
+        case STRING: return readString(ignoredString);
+        case NUMBER: return readNumber(ignoredNumber);
+        case BOOL: return readBool(ignoredBool);
+        case NULL_VALUE: return literal("null", 4);
+        default: return fail("expected value");
+        }
+    }
+};
+
+// "#rgb" or "#rrggbb", opaque; the color format of the game's JSON files
+inline bool parseHexColor(std::string_view text, uint32_t& rgba) {
+    if (text.empty() || text[0] != '#' || (text.size() != 4 && text.size() != 7)) return false;
+    uint32_t value = 0;
+    for (size_t i = 1; i < text.size(); ++i) {
+        char c = text[i];
+        uint32_t digit;
+        if (c >= '0' && c <= '9') digit = (uint32_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') digit = (uint32_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') digit = (uint32_t)(c - 'A' + 10);
+        else return false;
+        value = (value << 4) | digit;
+        if (text.size() == 4) value = (value << 4) | digit;
+    }
+    rgba = (value << 8) | 0xff;
+    return true;
+}
+
+// Whole file into `text`; false if it can't be opened
+inline bool readFile(const std::string& path, std::string& text) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    text.clear();
+    char buffer[16384];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0) text.append(buffer, n);
+    std::fclose(f);
+    return true;
+}
+
+} // namespace Json
+
+#endif // JSON_READER_H
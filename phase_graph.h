@@ -0,0 +1,97 @@
+// phase_graph.h
+// Runs a frame's update phases as a dependency graph on a JobPool
+// Phases declare which earlier phases they read from; phases with no path between them run
+// concurrently, and the caller works through the graph alongside the pool until it's done
+
+#ifndef PHASE_GRAPH_H
+#define PHASE_GRAPH_H
+
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "highway_sim.h"
+#include "job_system.h"
+
+namespace Sim {
+
+// Lets World split its per-tick traffic phases across a JobPool
+class PoolParallelFor : public ParallelFor {
+private:
+    JobPool& pool;
+
+public:
+    explicit PoolParallelFor(JobPool& jobPool) : pool(jobPool) {}
+
+    void run(int count, int grain, const std::function<void(int, int)>& body) override {
+        pool.parallelFor(count, grain, body);
+    }
+};
+
+class PhaseGraph {
+private:
+    struct Phase {
+        std::string name;
+        std::function<void()> run;
+        std::vector<int> dependents;
+        int dependencyCount = 0;
+    };
+
+    std::vector<Phase> phases;
+    std::unique_ptr<std::atomic<int>[]> pending; // unmet dependencies per phase during run()
+    std::atomic<int> unfinished{0};
+
+    void launch(JobPool& pool, int p) {
+        pool.submit([this, &pool, p] {
+            phases[p].run();
+            for (int d : phases[p].dependents) {
+                if (pending[d].fetch_sub(1) == 1) launch(pool, d);
+            }
+            unfinished.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+public:
+    // Dependencies are ids returned by earlier add() calls, so the graph can't have cycles
+    int add(const std::string& name, std::function<void()> run, std::initializer_list<int> after = {}) {
+        const int id = (int)phases.size();
+        Phase phase;
+        phase.name = name;
+        phase.run = std::move(run);
+        for (int d : after) {
+            if (d < 0 || d >= id) continue;
+            phases[d].dependents.push_back(id);
+            phase.dependencyCount++;
+        }
+        phases.push_back(std::move(phase));
+        pending.reset(new std::atomic<int>[phases.size()]);
+        return id;
+    }
+
+    int size() const { return (int)phases.size(); }
+    const std::string& name(int id) const { return phases[id].name; }
+
+    // Without a pool, phases run inline in the order they were added, which is a valid
+    // topological order by construction
+    void run(JobPool* pool) {
+        if (!pool) {
+            for (Phase& phase : phases) phase.run();
+            return;
+        }
+        unfinished.store((int)phases.size());
+        for (size_t p = 0; p < phases.size(); ++p) pending[p].store(phases[p].dependencyCount);
+        for (size_t p = 0; p < phases.size(); ++p) {
+            if (phases[p].dependencyCount == 0) launch(*pool, (int)p);
+        }
+        while (unfinished.load(std::memory_order_acquire) > 0) {
+            if (!pool->runOne()) std::this_thread::yield();
+        }
+    }
+};
+
+} // namespace Sim
+
+#endif // PHASE_GRAPH_H
@@ -0,0 +1,190 @@
+// replay.h
+// Replay files: episode seed, sim Params + per-tick input, with chained state hashes logged every K ticks
+// Verifying a replay re-simulates it and reports the first divergent tick and subsystem
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "highway_sim.h"
+#include "state_hash.h"
+
+namespace Sim {
+
+const uint32_t REPLAY_VERSION = 8;
+
+// Replay flags: physics from float and fixed-point builds differ, so a replay records which it used
+const uint32_t REPLAY_FLAG_FIXED_POINT = 1u << 0;
+
+inline uint32_t buildReplayFlags() {
+#ifdef HW_FIXED_POINT
+    return REPLAY_FLAG_FIXED_POINT;
+#else
+    return 0;
+#endif
+}
+
+struct ReplayHashRecord {
+    uint32_t tick;
+    uint32_t reserved;
+    uint64_t hashes[HASH_SUBSYSTEM_COUNT];
+};
+
+struct Replay {
+    uint64_t seed = 0;
+    uint32_t capacity = 0;     // vehicle slots of the recorded World
+    uint32_t hashInterval = 0; // K: a hash record every K ticks (0 = final tick only)
+    uint32_t flags = buildReplayFlags();
+    Params params;             // stored raw; the version is bumped whenever Params changes layout
+    std::vector<uint8_t> inputs;
+    std::vector<ReplayHashRecord> hashes;
+
+    bool save(const std::string& path) const {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        uint32_t header[8] = { 0x50525748u /* "HWRP" */, REPLAY_VERSION, flags, capacity, hashInterval,
+                               (uint32_t)inputs.size(), (uint32_t)hashes.size(), (uint32_t)sizeof(Params) };
+        bool ok = std::fwrite(header, sizeof(header), 1, f) == 1
+            && std::fwrite(&seed, sizeof(seed), 1, f) == 1
+            && std::fwrite(&params, sizeof(Params), 1, f) == 1
+            && std::fwrite(inputs.data(), 1, inputs.size(), f) == inputs.size()
+            && std::fwrite(hashes.data(), sizeof(ReplayHashRecord), hashes.size(), f) == hashes.size();
+        std::fclose(f);
+        return ok;
+    }
+
+    bool load(const std::string& path) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        uint32_t header[8];
+        bool ok = std::fread(header, sizeof(header), 1, f) == 1
+            && header[0] == 0x50525748u && header[1] == REPLAY_VERSION && header[7] == sizeof(Params)
+            && std::fread(&seed, sizeof(seed), 1, f) == 1
+            && std::fread(&params, sizeof(Params), 1, f) == 1;
+        // The counts are untrusted: they must describe exactly the bytes left in the file
+        long start = ok ? std::ftell(f) : -1;
+        long size = start >= 0 && std::fseek(f, 0, SEEK_END) == 0 ? std::ftell(f) : -1;
+        ok = ok && size >= start && std::fseek(f, start, SEEK_SET) == 0
+            && (uint64_t)(size - start) == (uint64_t)header[5] + (uint64_t)header[6] * sizeof(ReplayHashRecord);
+        if (ok) {
+            flags = header[2];
+            capacity = header[3];
+            hashInterval = header[4];
+            inputs.resize(header[5]);
+            hashes.resize(header[6]);
+            ok = std::fread(inputs.data(), 1, inputs.size(), f) == inputs.size()
+                && std::fread(hashes.data(), sizeof(ReplayHashRecord), hashes.size(), f) == hashes.size();
+        }
+        std::fclose(f);
+        return ok;
+    }
+};
+
+// Records one game of a World; call recordTick() right after every World::step()
+class ReplayRecorder {
+private:
+    uint64_t chain[HASH_SUBSYSTEM_COUNT];
+
+    void pushRecord(uint32_t tick) {
+        ReplayHashRecord r = {};
+        r.tick = tick;
+        for (int s = 0; s < HASH_SUBSYSTEM_COUNT; ++s) r.hashes[s] = chain[s];
+        replay.hashes.push_back(r);
+    }
+
+public:
+    Replay replay;
+
+    void begin(const Params& params, uint64_t seed, int capacity, uint32_t hashInterval) {
+        replay = Replay();
+        replay.params = params;
+        replay.seed = seed;
+        replay.capacity = (uint32_t)capacity;
+        replay.hashInterval = hashInterval;
+        for (int s = 0; s < HASH_SUBSYSTEM_COUNT; ++s) chain[s] = 0;
+    }
+
+    void recordTick(const World& world, int g, uint32_t input) {
+        replay.inputs.push_back((uint8_t)input);
+        hashGameState(world, g, chain);
+        uint32_t tick = (uint32_t)replay.inputs.size();
+        if (replay.hashInterval > 0 && tick % replay.hashInterval == 0) pushRecord(tick);
+    }
+
+    // Make sure the last tick is always covered, then write the file
+    bool finish(const std::string& path) {
+        uint32_t tick = (uint32_t)replay.inputs.size();
+        if (tick > 0 && (replay.hashes.empty() || replay.hashes.back().tick != tick)) pushRecord(tick);
+        return replay.save(path);
+    }
+};
+
+struct Divergence {
+    bool diverged = false;
+    uint32_t tick = 0;          // first logged tick whose hash differs
+    uint32_t lastGoodTick = 0;  // last logged tick that still matched
+    int subsystem = -1;         // first differing HashSubsystem at `tick`
+};
+
+inline int firstDifferingSubsystem(const ReplayHashRecord& a, const ReplayHashRecord& b) {
+    for (int s = 0; s < HASH_SUBSYSTEM_COUNT; ++s) {
+        if (a.hashes[s] != b.hashes[s]) return s;
+    }
+    return -1;
+}
+
+// Re-simulate a replay from its seed and params and compare against the logged hashes
+inline Divergence verifyReplay(const Replay& replay) {
+    Divergence result;
+    World world(replay.params, 1, (int)replay.capacity, 0);
+    world.reset(0, replay.seed);
+
+    uint64_t chain[HASH_SUBSYSTEM_COUNT] = {};
+    size_t next = 0;
+    for (uint32_t t = 0; t < replay.inputs.size() && next < replay.hashes.size(); ++t) {
+        world.step(0, replay.inputs[t]);
+        hashGameState(world, 0, chain);
+        const ReplayHashRecord& logged = replay.hashes[next];
+        if (logged.tick != t + 1) continue;
+        ReplayHashRecord actual = logged;
+        for (int s = 0; s < HASH_SUBSYSTEM_COUNT; ++s) actual.hashes[s] = chain[s];
+        int subsystem = firstDifferingSubsystem(logged, actual);
+        if (subsystem >= 0) {
+            result.diverged = true;
+            result.tick = logged.tick;
+            result.subsystem = subsystem;
+            return result;
+        }
+        result.lastGoodTick = logged.tick;
+        next++;
+    }
+    return result;
+}
+
+// Compare the hash logs of two recordings of the same run (e.g. from two builds) without
+// re-simulating. Hashes are chained, so matches form a prefix and a binary search finds the
+// first divergent record in O(log n).
+inline Divergence compareReplays(const Replay& a, const Replay& b) {
+    Divergence result;
+    size_t n = std::min(a.hashes.size(), b.hashes.size());
+    size_t lo = 0, hi = n; // first mismatch lies in [lo, hi]
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (a.hashes[mid].tick == b.hashes[mid].tick && firstDifferingSubsystem(a.hashes[mid], b.hashes[mid]) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo > 0) result.lastGoodTick = a.hashes[lo - 1].tick;
+    if (lo < n) {
+        result.diverged = true;
+        result.tick = a.hashes[lo].tick;
+        result.subsystem = firstDifferingSubsystem(a.hashes[lo], b.hashes[lo]);
+    }
+    return result;
+}
+
+} // namespace Sim
+
+#endif // REPLAY_H
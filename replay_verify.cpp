@@ -0,0 +1,55 @@
+// replay_verify.cpp
+// Command-line checker for replay files written by highway_racing --record
+//
+//   replay_verify run.hwr            re-simulate and check the logged hashes
+//   replay_verify a.hwr b.hwr        compare two recordings' hash logs (no simulation)
+//
+// Build: g++ -std=c++17 -O2 replay_verify.cpp -o replay_verify
+//        (add -DHW_FIXED_POINT to check replays from a fixed-point game build)
+
+#include <iostream>
+#include "replay.h"
+
+static void report(const Sim::Divergence& d, size_t ticks) {
+    if (!d.diverged) {
+        std::cout << "OK: " << ticks << " ticks, no divergence" << std::endl;
+        return;
+    }
+    std::cout << "DIVERGED at tick " << d.tick
+              << " (last matching tick " << d.lastGoodTick << ")"
+              << " in subsystem '" << Sim::hashSubsystemName(d.subsystem) << "'" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <replay.hwr> [other.hwr]" << std::endl;
+        return 2;
+    }
+
+    Sim::Replay a;
+    if (!a.load(argv[1])) {
+        std::cerr << "Cannot read replay " << argv[1] << std::endl;
+        return 2;
+    }
+
+    Sim::Divergence d;
+    if (argc == 3) {
+        Sim::Replay b;
+        if (!b.load(argv[2])) {
+            std::cerr << "Cannot read replay " << argv[2] << std::endl;
+            return 2;
+        }
+        d = Sim::compareReplays(a, b);
+    } else {
+        if (a.flags != Sim::buildReplayFlags()) {
+            std::cerr << "Replay was recorded with "
+                      << ((a.flags & Sim::REPLAY_FLAG_FIXED_POINT) ? "fixed-point" : "float")
+                      << " physics; rebuild replay_verify to match" << std::endl;
+            return 2;
+        }
+        d = Sim::verifyReplay(a);
+    }
+
+    report(d, a.inputs.size());
+    return d.diverged ? 1 : 0;
+}
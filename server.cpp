@@ -0,0 +1,1013 @@
+// server.cpp - WebSocket telemetry server for the web version (game.js connects to ws://localhost:9002)
+//   server [port] [--threads n]     serve on `port` (default 9002). Each worker thread runs its own
+//                                   event loop (epoll on Linux, poll elsewhere) and, on Linux,
+//                                   its own listening socket on the shared port
+//   server --bench [port] [clients] [seconds]
+//                                   load a running server with `clients` connections (default
+//                                   10000), each sending telemetry at 60 Hz like game.js
+//   server --parse-bench [messages] single-core telemetry parsing rates: the fixed-shape scan, the
+//                                   general path, whole frames, and nlohmann/json when available
+// Every text message is read as telemetry and answered with the fps/debug fields game.js shows.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "telemetry.h"
+#include "timer_wheel.h"
+#include "websocket.h"
+
+#if defined(__has_include)
+#  if __has_include(<nlohmann/json.hpp>)
+#    include <nlohmann/json.hpp>
+#    define HW_HAS_NLOHMANN_JSON 1
+#  elif __has_include("json.hpp")
+#    include "json.hpp"
+#    define HW_HAS_NLOHMANN_JSON 1
+#  endif
+#endif
+#ifndef HW_HAS_NLOHMANN_JSON
+#  define HW_HAS_NLOHMANN_JSON 0
+#endif
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET SocketHandle;
+const SocketHandle NO_SOCKET = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+typedef int SocketHandle;
+const SocketHandle NO_SOCKET = -1;
+#endif
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+// Socket calls that differ between Winsock and POSIX
+static void closeSocket(SocketHandle s) {
+#ifdef _WIN32
+    closesocket(s);
+#else
+    ::close(s);
+#endif
+}
+
+static bool wouldBlock() {
+#ifdef _WIN32
+    const int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINPROGRESS || errno == EINTR;
+#endif
+}
+
+// accept() failed for want of descriptors; the pending connection stays queued
+static bool outOfDescriptors() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEMFILE || WSAGetLastError() == WSAENOBUFS;
+#else
+    return errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM;
+#endif
+}
+
+static void configureSocket(SocketHandle s) {
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+#endif
+    // Replies are tiny and latency matters more than packet count
+    int noDelay = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+}
+
+static long receive(SocketHandle s, char* buffer, size_t length) {
+    return (long)recv(s, buffer, (int)length, 0);
+}
+
+static long transmit(SocketHandle s, const char* data, size_t length) {
+    return (long)send(s, data, (int)length, SEND_FLAGS);
+}
+
+// Readiness for a set of sockets, each registered with a caller-chosen 64-bit token.
+// Level-triggered on every platform, so a socket left with unread data is reported again.
+struct PollEvent {
+    uint64_t token;
+    bool readable, writable, failed;
+};
+
+class Poller {
+private:
+#ifdef __linux__
+    int epoll;
+    std::vector<epoll_event> ready;
+
+    // A half-closed peer keeps EPOLLRDHUP raised, so it is only asked for while reading
+    static uint32_t mask(bool read, bool write) {
+        return (read ? (uint32_t)(EPOLLIN | EPOLLRDHUP) : 0u) | (write ? (uint32_t)EPOLLOUT : 0u);
+    }
+
+public:
+    Poller() : epoll(epoll_create1(EPOLL_CLOEXEC)), ready(1024) {}
+    ~Poller() { ::close(epoll); }
+
+    bool add(SocketHandle s, uint64_t token, bool read, bool write) {
+        epoll_event e = {};
+        e.events = mask(read, write);
+        e.data.u64 = token;
+        return epoll_ctl(epoll, EPOLL_CTL_ADD, s, &e) == 0;
+    }
+
+    void modify(SocketHandle s, uint64_t token, bool read, bool write) {
+        epoll_event e = {};
+        e.events = mask(read, write);
+        e.data.u64 = token;
+        epoll_ctl(epoll, EPOLL_CTL_MOD, s, &e);
+    }
+
+    void remove(SocketHandle s) {
+        epoll_ctl(epoll, EPOLL_CTL_DEL, s, nullptr);
+    }
+
+    void wait(int timeoutMs, std::vector<PollEvent>& events) {
+        events.clear();
+        const int n = epoll_wait(epoll, ready.data(), (int)ready.size(), timeoutMs);
+        for (int i = 0; i < n; ++i) {
+            const uint32_t e = ready[i].events;
+            events.push_back({ ready[i].data.u64, (e & (EPOLLIN | EPOLLRDHUP)) != 0, (e & EPOLLOUT) != 0,
+                               (e & (EPOLLERR | EPOLLHUP)) != 0 });
+        }
+        if (n == (int)ready.size()) ready.resize(ready.size() * 2);
+    }
+#else
+    std::vector<pollfd> fds;
+    std::vector<uint64_t> tokens;
+    std::unordered_map<SocketHandle, size_t> index;
+
+public:
+    bool add(SocketHandle s, uint64_t token, bool read, bool write) {
+        pollfd p = {};
+        p.fd = s;
+        p.events = (short)((read ? POLLIN : 0) | (write ? POLLOUT : 0));
+        index[s] = fds.size();
+        fds.push_back(p);
+        tokens.push_back(token);
+        return true;
+    }
+
+    void modify(SocketHandle s, uint64_t token, bool read, bool write) {
+        auto found = index.find(s);
+        if (found == index.end()) return;
+        fds[found->second].events = (short)((read ? POLLIN : 0) | (write ? POLLOUT : 0));
+        tokens[found->second] = token;
+    }
+
+    // The last entry moves into the hole
+    void remove(SocketHandle s) {
+        auto found = index.find(s);
+        if (found == index.end()) return;
+        const size_t at = found->second;
+        index.erase(found);
+        if (at + 1 != fds.size()) {
+            fds[at] = fds.back();
+            tokens[at] = tokens.back();
+            index[fds[at].fd] = at;
+        }
+        fds.pop_back();
+        tokens.pop_back();
+    }
+
+    void wait(int timeoutMs, std::vector<PollEvent>& events) {
+        events.clear();
+#ifdef _WIN32
+        const int n = fds.empty() ? (Sleep((DWORD)timeoutMs), 0) : WSAPoll(fds.data(), (ULONG)fds.size(), timeoutMs);
+#else
+        const int n = ::poll(fds.data(), (nfds_t)fds.size(), timeoutMs);
+#endif
+        for (size_t i = 0; n > 0 && i < fds.size(); ++i) {
+            const short e = fds[i].revents;
+            if (!e) continue;
+            events.push_back({ tokens[i], (e & POLLIN) != 0, (e & POLLOUT) != 0,
+                               (e & (POLLERR | POLLHUP | POLLNVAL)) != 0 });
+        }
+    }
+#endif
+};
+
+// Largest message a client may send, and the reply backlog past which a client stops being read
+const size_t MAX_MESSAGE_BYTES = 64 * 1024;
+const size_t MAX_PENDING_REPLY_BYTES = 1024 * 1024;
+
+// Connection timers count whole seconds
+const uint64_t HANDSHAKE_TIMEOUT = 10;
+const uint64_t IDLE_PING_AFTER = 30;
+const uint64_t IDLE_DROP_AFTER = 60;
+const uint64_t CLOSE_TIMEOUT = 5;
+
+// Token of a worker's listening socket; connections use (generation << 32 | slot)
+const uint64_t LISTENER_TOKEN = ~0ull;
+
+struct ServerStats {
+    std::atomic<int64_t> clients{0};
+    std::atomic<uint64_t> accepted{0}, messages{0}, replies{0}, protocolErrors{0};
+    std::atomic<uint64_t> general{0}, rejected{0}; // messages off the fast path; unreadable ones
+};
+
+struct Connection {
+    SocketHandle socket = NO_SOCKET;
+    uint32_t generation = 0;
+    bool upgraded = false;
+    bool closeSent = false;  // no more frames are read or written once the close frame is queued
+    bool watchingWrites = false;
+    bool reading = true;
+    std::string in;          // bytes of an unfinished handshake or frame
+    std::string out;         // replies the socket has not taken yet, from outSent on
+    size_t outSent = 0;
+    std::string message;     // fragments of the message being assembled
+    uint8_t messageOpcode = 0;
+    uint64_t lastSeen = 0;   // second of the last bytes received
+    Sim::TimerHandle timer;
+};
+
+// One event loop: its own listening socket, connections, timers and receive buffer
+class Worker {
+private:
+    SocketHandle listener;
+    ServerStats& stats;
+    Poller poller;
+    Sim::TimerWheel timers;
+    std::vector<std::unique_ptr<Connection>> connections; // by slot
+    std::vector<uint32_t> freeSlots;
+    std::vector<char> scratch;
+    std::vector<PollEvent> events;
+    bool acceptPaused = false; // out of descriptors; the listener is ignored until the next second
+
+    static uint64_t tokenOf(uint32_t slot, const Connection& c) {
+        return (uint64_t)c.generation << 32 | slot;
+    }
+
+    void accept() {
+        for (;;) {
+            SocketHandle s = ::accept(listener, nullptr, nullptr);
+            if (s == NO_SOCKET) {
+                // The listener stays ready while the backlog waits, so stop watching it for a while
+                if (outOfDescriptors()) {
+                    acceptPaused = true;
+                    poller.modify(listener, LISTENER_TOKEN, false, false);
+                }
+                return;
+            }
+            configureSocket(s);
+            uint32_t slot;
+            if (freeSlots.empty()) {
+                slot = (uint32_t)connections.size();
+                connections.emplace_back(new Connection());
+            } else {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            Connection& c = *connections[slot];
+            c.socket = s;
+            c.lastSeen = timers.currentTick();
+            c.timer = timers.schedule(timers.currentTick() + HANDSHAKE_TIMEOUT, slot);
+            stats.clients++;
+            stats.accepted++;
+            if (!poller.add(s, tokenOf(slot, c), true, false)) drop(slot);
+        }
+    }
+
+    // Forget the connection; its slot and buffers are reused by the next accept
+    void drop(uint32_t slot) {
+        Connection& c = *connections[slot];
+        if (c.socket == NO_SOCKET) return;
+        poller.remove(c.socket);
+        closeSocket(c.socket);
+        timers.cancel(c.timer);
+        stats.clients--;
+        c.socket = NO_SOCKET;
+        c.generation++;
+        c.upgraded = c.closeSent = c.watchingWrites = false;
+        c.reading = true;
+        c.in.clear();
+        c.out.clear();
+        c.outSent = 0;
+        c.message.clear();
+        c.messageOpcode = 0;
+        freeSlots.push_back(slot);
+    }
+
+    void queueFrame(Connection& c, uint8_t opcode, const char* payload, size_t length) {
+        char header[Net::MAX_FRAME_HEADER];
+        c.out.append(header, Net::encodeFrameHeader(opcode, length, header));
+        c.out.append(payload, length);
+    }
+
+    // Queue the close frame; the socket closes once it has been sent
+    void queueClose(uint32_t slot, uint16_t code) {
+        Connection& c = *connections[slot];
+        if (c.closeSent) return;
+        char payload[2] = { (char)(code >> 8), (char)code };
+        queueFrame(c, Net::OP_CLOSE, payload, code ? 2 : 0);
+        c.closeSent = true;
+        timers.cancel(c.timer);
+        c.timer = timers.schedule(timers.currentTick() + CLOSE_TIMEOUT, slot);
+    }
+
+    void failConnection(uint32_t slot, uint16_t code) {
+        stats.protocolErrors++;
+        queueClose(slot, code);
+    }
+
+    // Send what the socket takes; watch for writability while replies are left, and stop
+    // reading from a client that lets too many pile up
+    void flush(uint32_t slot) {
+        Connection& c = *connections[slot];
+        while (c.outSent < c.out.size()) {
+            const long n = transmit(c.socket, c.out.data() + c.outSent, c.out.size() - c.outSent);
+            if (n <= 0) {
+                if (n < 0 && wouldBlock()) break;
+                drop(slot);
+                return;
+            }
+            c.outSent += (size_t)n;
+        }
+        if (c.outSent == c.out.size()) {
+            c.out.clear();
+            c.outSent = 0;
+            if (c.closeSent) {
+                drop(slot);
+                return;
+            }
+        }
+        const bool pending = !c.out.empty();
+        const bool read = c.out.size() - c.outSent < MAX_PENDING_REPLY_BYTES;
+        if (pending != c.watchingWrites || read != c.reading) {
+            c.watchingWrites = pending;
+            c.reading = read;
+            poller.modify(c.socket, tokenOf(slot, c), read, pending);
+        }
+    }
+
+    void onMessage(uint32_t slot, uint8_t opcode, const char* data, size_t length) {
+        Connection& c = *connections[slot];
+        if (opcode != Net::OP_TEXT) {
+            failConnection(slot, Net::CLOSE_UNSUPPORTED_DATA);
+            return;
+        }
+        // game.js's own messages take the fixed-shape scan; anything else is checked and parsed in full
+        Net::Telemetry t;
+        const bool scanned = Net::scanTelemetry(data, length, t);
+        if (!scanned && !Net::validUtf8(data, length)) {
+            failConnection(slot, Net::CLOSE_INVALID_DATA);
+            return;
+        }
+        stats.messages++;
+        if (!scanned) {
+            stats.general++;
+            if (!Net::parseTelemetry(std::string_view(data, length), t)) {
+                stats.rejected++;
+                return;
+            }
+        }
+        char reply[Net::TELEMETRY_JSON_MAX];
+        queueFrame(c, Net::OP_TEXT, reply, Net::formatTelemetry(t, reply));
+        stats.replies++;
+    }
+
+    void onControl(uint32_t slot, const Net::Frame& f) {
+        Connection& c = *connections[slot];
+        if (f.opcode == Net::OP_PING) {
+            queueFrame(c, Net::OP_PONG, f.payload, f.length);
+        } else if (f.opcode == Net::OP_CLOSE) {
+            // Echo the peer's status code, or none if it sent none
+            uint16_t code = 0;
+            if (f.length == 1) {
+                failConnection(slot, Net::CLOSE_PROTOCOL_ERROR);
+                return;
+            }
+            if (f.length >= 2) {
+                code = (uint16_t)((uint8_t)f.payload[0] << 8 | (uint8_t)f.payload[1]);
+                if (!Net::validCloseCode(code)) {
+                    failConnection(slot, Net::CLOSE_PROTOCOL_ERROR);
+                    return;
+                }
+                if (!Net::validUtf8(f.payload + 2, f.length - 2)) {
+                    failConnection(slot, Net::CLOSE_INVALID_DATA);
+                    return;
+                }
+            }
+            queueClose(slot, code);
+        }
+        // Pongs only prove the client is alive, which any bytes already do
+    }
+
+    // Frames at the start of data[0..size); returns the bytes used. Complete messages are handled
+    // where they lie, so only fragmented messages are copied
+    size_t onFrames(uint32_t slot, char* data, size_t size) {
+        Connection& c = *connections[slot];
+        size_t used = 0;
+        while (!c.closeSent && used < size) {
+            Net::Frame f;
+            uint16_t error;
+            const size_t n = Net::decodeFrame(data + used, size - used, MAX_MESSAGE_BYTES, f, error);
+            if (error) {
+                failConnection(slot, error);
+                break;
+            }
+            if (n == 0) break;
+            used += n;
+            if (f.opcode & 0x8) {
+                onControl(slot, f);
+            } else if (f.opcode != Net::OP_CONTINUATION) {
+                if (c.messageOpcode) {
+                    failConnection(slot, Net::CLOSE_PROTOCOL_ERROR); // new message inside a fragmented one
+                } else if (f.fin) {
+                    onMessage(slot, f.opcode, f.payload, f.length);
+                } else {
+                    c.messageOpcode = f.opcode;
+                    c.message.assign(f.payload, f.length);
+                }
+            } else if (!c.messageOpcode) {
+                failConnection(slot, Net::CLOSE_PROTOCOL_ERROR); // continuation of nothing
+            } else if (c.message.size() + f.length > MAX_MESSAGE_BYTES) {
+                failConnection(slot, Net::CLOSE_TOO_BIG);
+            } else {
+                c.message.append(f.payload, f.length);
+                if (f.fin) {
+                    onMessage(slot, c.messageOpcode, c.message.data(), c.message.size());
+                    c.messageOpcode = 0;
+                    c.message.clear();
+                }
+            }
+        }
+        return c.closeSent ? size : used;
+    }
+
+    // The request head, then anything the client sent behind it
+    void onHandshake(uint32_t slot) {
+        Connection& c = *connections[slot];
+        size_t length = 0;
+        std::string response;
+        const Net::HandshakeResult result = Net::parseHandshake(c.in, length, response);
+        if (result == Net::HANDSHAKE_INCOMPLETE) return;
+        c.out += response;
+        c.in.erase(0, length);
+        if (result == Net::HANDSHAKE_REFUSED) {
+            c.closeSent = true;
+            return;
+        }
+        c.upgraded = true;
+        timers.cancel(c.timer);
+        c.timer = timers.schedule(timers.currentTick() + IDLE_PING_AFTER, slot);
+        if (!c.in.empty()) c.in.erase(0, onFrames(slot, &c.in[0], c.in.size()));
+    }
+
+    void onReadable(uint32_t slot) {
+        Connection& c = *connections[slot];
+        const long n = receive(c.socket, scratch.data(), scratch.size());
+        if (n <= 0) {
+            if (n < 0 && wouldBlock()) return;
+            drop(slot);
+            return;
+        }
+        c.lastSeen = timers.currentTick();
+        if (c.closeSent) return;
+        if (!c.upgraded) {
+            c.in.append(scratch.data(), (size_t)n);
+            onHandshake(slot);
+        } else if (c.in.empty()) {
+            // The usual case: whole frames, decoded in the receive buffer
+            const size_t used = onFrames(slot, scratch.data(), (size_t)n);
+            c.in.assign(scratch.data() + used, (size_t)n - used);
+        } else {
+            c.in.append(scratch.data(), (size_t)n);
+            c.in.erase(0, onFrames(slot, &c.in[0], c.in.size()));
+        }
+        flush(slot);
+    }
+
+    // Handshake, closing-handshake and idle deadlines. An idle client is pinged once, then dropped
+    void onTimer(uint32_t slot) {
+        Connection& c = *connections[slot];
+        if (c.socket == NO_SOCKET) return;
+        if (!c.upgraded || c.closeSent) {
+            drop(slot);
+            return;
+        }
+        const uint64_t now = timers.currentTick(), idle = now - c.lastSeen;
+        if (idle >= IDLE_DROP_AFTER) {
+            drop(slot);
+            return;
+        }
+        if (idle >= IDLE_PING_AFTER) {
+            queueFrame(c, Net::OP_PING, nullptr, 0);
+            c.timer = timers.schedule(c.lastSeen + IDLE_DROP_AFTER, slot);
+            flush(slot);
+        } else {
+            c.timer = timers.schedule(c.lastSeen + IDLE_PING_AFTER, slot);
+        }
+    }
+
+public:
+    Worker(SocketHandle listenSocket, ServerStats& serverStats)
+        : listener(listenSocket), stats(serverStats), scratch(256 * 1024) {
+        poller.add(listener, LISTENER_TOKEN, true, false);
+    }
+
+    ~Worker() {
+        for (uint32_t slot = 0; slot < (uint32_t)connections.size(); ++slot) drop(slot);
+        closeSocket(listener);
+    }
+
+    void run(const std::atomic<bool>& running) {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        while (running) {
+            poller.wait(250, events);
+            for (const PollEvent& e : events) {
+                if (e.token == LISTENER_TOKEN) {
+                    accept();
+                    continue;
+                }
+                const uint32_t slot = (uint32_t)e.token;
+                if (slot >= connections.size() || connections[slot]->generation != (uint32_t)(e.token >> 32)
+                    || connections[slot]->socket == NO_SOCKET) {
+                    continue; // dropped earlier in this batch
+                }
+                if (e.writable) flush(slot);
+                if (e.readable && connections[slot]->socket != NO_SOCKET && connections[slot]->reading) {
+                    onReadable(slot);
+                } else if (e.failed && connections[slot]->socket != NO_SOCKET) {
+                    drop(slot);
+                }
+            }
+            const uint64_t second = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - start).count();
+            while (timers.currentTick() < second) {
+                timers.advance([this](uint32_t slot) { onTimer(slot); });
+                if (acceptPaused) {
+                    acceptPaused = false;
+                    poller.modify(listener, LISTENER_TOKEN, true, false);
+                }
+            }
+        }
+    }
+};
+
+static SocketHandle listenOn(int port, bool shared, std::string& message) {
+    SocketHandle s = socket(AF_INET, SOCK_STREAM, 0);
+    if (s == NO_SOCKET) {
+        message = "cannot create a socket";
+        return NO_SOCKET;
+    }
+    int one = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&one, sizeof(one));
+#ifdef SO_REUSEPORT
+    if (shared) setsockopt(s, SOL_SOCKET, SO_REUSEPORT, (const char*)&one, sizeof(one));
+#else
+    (void)shared;
+#endif
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)port);
+    if (bind(s, (const sockaddr*)&address, sizeof(address)) != 0 || listen(s, SOMAXCONN) != 0) {
+        closeSocket(s);
+        message = "cannot listen on port " + std::to_string(port);
+        return NO_SOCKET;
+    }
+    configureSocket(s);
+    return s;
+}
+
+// Let one process hold as many sockets as the hard limit allows
+static void raiseSocketLimit() {
+#ifndef _WIN32
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif
+}
+
+static std::atomic<bool> running(true);
+
+static void stopRunning(int) {
+    running = false;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int serve(int port, int threads) {
+#ifndef SO_REUSEPORT
+    threads = 1;
+#endif
+    raiseSocketLimit();
+    ServerStats stats;
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < threads; ++i) {
+        std::string message;
+        SocketHandle s = listenOn(port, threads > 1, message);
+        if (s == NO_SOCKET) {
+            std::fprintf(stderr, "Error: %s\n", message.c_str());
+            return 1;
+        }
+        workers.emplace_back(new Worker(s, stats));
+    }
+    std::vector<std::thread> loops;
+    for (auto& worker : workers) loops.emplace_back([&worker] { worker->run(running); });
+    std::printf("Serving telemetry on ws://localhost:%d with %d thread%s\n", port, threads, threads == 1 ? "" : "s");
+    std::fflush(stdout);
+
+    // A status line every 10 seconds while anyone is connected; CPU is for the whole process
+    auto last = std::chrono::steady_clock::now();
+    std::clock_t lastCpu = std::clock();
+    uint64_t lastMessages = 0;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        const double wall = secondsSince(last);
+        if (wall < 10) continue;
+        const std::clock_t cpu = std::clock();
+        const uint64_t messages = stats.messages;
+        if (stats.clients > 0 || messages != lastMessages) {
+            const double cpuSeconds = (double)(cpu - lastCpu) / CLOCKS_PER_SEC;
+            const double rate = (messages - lastMessages) / wall;
+            std::printf("%lld clients, %.0f msgs/s, cpu %.0f%%, %.0f msgs/s per core\n", (long long)stats.clients.load(),
+                        rate, 100 * cpuSeconds / wall, cpuSeconds > 0 ? (messages - lastMessages) / cpuSeconds : 0.0);
+            std::fflush(stdout);
+        }
+        last = std::chrono::steady_clock::now();
+        lastCpu = cpu;
+        lastMessages = messages;
+    }
+    for (auto& loop : loops) loop.join();
+    std::printf("Stopped: %llu connections, %llu messages (%llu off the fast path, %llu unreadable), %llu replies, "
+                "%llu protocol errors\n", (unsigned long long)stats.accepted, (unsigned long long)stats.messages,
+                (unsigned long long)stats.general, (unsigned long long)stats.rejected, (unsigned long long)stats.replies,
+                (unsigned long long)stats.protocolErrors);
+    return 0;
+}
+
+// Load test client: one event loop driving `clients` connections. Sends are spread evenly over
+// time so the server sees the steady trickle real browsers produce, and every reply is checked
+// against the telemetry it answers.
+struct BenchClient {
+    SocketHandle socket = NO_SOCKET;
+    bool requested = false, upgraded = false;
+    std::string in;
+    uint32_t sent = 0, received = 0;
+};
+
+static Net::Telemetry benchTelemetry(uint32_t client, uint32_t sequence) {
+    Net::Telemetry t;
+    t.fps = 55 + (int32_t)(sequence % 6);
+    t.throttle = (int32_t)((client * 7 + sequence) % 170);
+    t.steer = (int32_t)(sequence % 3) - 1;
+    t.handbrake = (sequence & 15) == 0;
+    return t;
+}
+
+static int bench(int port, int clientCount, double seconds) {
+    raiseSocketLimit();
+    const int RATE = 60;
+    std::vector<BenchClient> clients(clientCount);
+    Poller poller;
+    std::vector<PollEvent> events;
+    std::vector<char> scratch(256 * 1024);
+    uint64_t mismatched = 0, failed = 0;
+
+    const char* request = "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+
+    auto fail = [&](int i) {
+        BenchClient& c = clients[i];
+        if (c.socket == NO_SOCKET) return;
+        poller.remove(c.socket);
+        closeSocket(c.socket);
+        c.socket = NO_SOCKET;
+        c.upgraded = false;
+        failed++;
+    };
+
+    // Replies are whole unmasked frames; each must match what the client sent in that position
+    auto onReadable = [&](int i) {
+        BenchClient& c = clients[i];
+        const long n = receive(c.socket, scratch.data(), scratch.size());
+        if (n <= 0) {
+            if (!(n < 0 && wouldBlock())) fail(i);
+            return;
+        }
+        c.in.append(scratch.data(), (size_t)n);
+        size_t at = 0;
+        if (!c.upgraded) {
+            const size_t head = c.in.find("\r\n\r\n");
+            if (head == std::string::npos) return;
+            if (c.in.compare(0, 12, "HTTP/1.1 101") != 0) {
+                fail(i);
+                return;
+            }
+            c.upgraded = true;
+            at = head + 4;
+        }
+        char expected[Net::TELEMETRY_JSON_MAX];
+        while (c.in.size() - at >= 2) {
+            const size_t length = (uint8_t)c.in[at + 1] & 0x7F;
+            if (length >= 126 || c.in.size() - at < 2 + length) break;
+            const size_t want = Net::formatTelemetry(benchTelemetry((uint32_t)i, c.received), expected);
+            if (((uint8_t)c.in[at] & 0x0F) == Net::OP_TEXT) {
+                if (length != want || c.in.compare(at + 2, length, expected, want) != 0) mismatched++;
+                c.received++;
+            }
+            at += 2 + length;
+        }
+        c.in.erase(0, at);
+    };
+
+    auto sendTelemetry = [&](int i) {
+        BenchClient& c = clients[i];
+        char payload[Net::TELEMETRY_JSON_MAX], frame[Net::TELEMETRY_JSON_MAX + 6];
+        const size_t length = Net::formatTelemetry(benchTelemetry((uint32_t)i, c.sent), payload);
+        const uint8_t key[4] = { (uint8_t)i, (uint8_t)(c.sent >> 3), 0x5a, 0xc3 };
+        frame[0] = (char)(0x80 | Net::OP_TEXT);
+        frame[1] = (char)(0x80 | length);
+        std::memcpy(frame + 2, key, 4);
+        std::memcpy(frame + 6, payload, length);
+        Net::applyMask(frame + 6, length, key);
+        if (transmit(c.socket, frame, length + 6) != (long)(length + 6)) fail(i);
+        else c.sent++;
+    };
+
+    // Connect in batches the listen backlog can absorb
+    const auto start = std::chrono::steady_clock::now();
+    int upgraded = 0;
+    for (int next = 0; (next < clientCount || upgraded + (int)failed < clientCount) && secondsSince(start) < 60;) {
+        for (; next < clientCount && next - upgraded - (int)failed < 512; ++next) {
+            BenchClient& c = clients[next];
+            c.socket = socket(AF_INET, SOCK_STREAM, 0);
+            if (c.socket == NO_SOCKET) {
+                failed++;
+                continue;
+            }
+            configureSocket(c.socket);
+            connect(c.socket, (const sockaddr*)&address, sizeof(address));
+            poller.add(c.socket, (uint64_t)next, false, true);
+        }
+        poller.wait(100, events);
+        for (const PollEvent& e : events) {
+            const int i = (int)e.token;
+            BenchClient& c = clients[i];
+            if (c.socket == NO_SOCKET) continue;
+            if (e.failed) {
+                fail(i);
+            } else if (e.writable && !c.requested) {
+                c.requested = true;
+                if (transmit(c.socket, request, std::strlen(request)) < 0) fail(i);
+                else poller.modify(c.socket, (uint64_t)i, true, false);
+            } else if (e.readable && !c.upgraded) {
+                onReadable(i);
+                if (c.upgraded) upgraded++;
+            }
+        }
+    }
+    std::printf("%d of %d clients connected in %.1f s\n", upgraded, clientCount, secondsSince(start));
+    if (upgraded == 0) return 1;
+
+    // Steady phase: send whatever is due, read whatever came back
+    const auto steady = std::chrono::steady_clock::now();
+    const std::clock_t cpuStart = std::clock();
+    uint64_t sentTotal = 0, receivedBefore = 0;
+    for (const BenchClient& c : clients) receivedBefore += c.received;
+    int cursor = 0;
+    for (double elapsed = 0; elapsed < seconds && running; elapsed = secondsSince(steady)) {
+        const uint64_t due = (uint64_t)(elapsed * RATE * upgraded);
+        for (int guard = 0; sentTotal < due && guard < clientCount; ++guard) {
+            if (clients[cursor].upgraded) {
+                sendTelemetry(cursor);
+                sentTotal++;
+            }
+            cursor = (cursor + 1) % clientCount;
+        }
+        poller.wait(sentTotal < due ? 0 : 1, events);
+        for (const PollEvent& e : events) {
+            const int i = (int)e.token;
+            if (clients[i].socket == NO_SOCKET) continue;
+            if (e.readable) onReadable(i);
+            else if (e.failed) fail(i);
+        }
+    }
+    const double wall = secondsSince(steady);
+    const double cpuSeconds = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    uint64_t received = 0;
+    for (const BenchClient& c : clients) received += c.received;
+    received -= receivedBefore;
+    std::printf("sent %.0f msgs/s (target %d), replies %.0f msgs/s, %llu behind, %llu mismatched, %llu dropped\n",
+                sentTotal / wall, RATE * upgraded, received / wall,
+                (unsigned long long)(sentTotal > received ? sentTotal - received : 0),
+                (unsigned long long)mismatched, (unsigned long long)failed);
+    std::printf("bench client cpu %.0f%%\n", 100 * cpuSeconds / wall);
+    for (BenchClient& c : clients) {
+        if (c.socket != NO_SOCKET) closeSocket(c.socket);
+    }
+    return mismatched || failed ? 1 : 0;
+}
+
+// Best of `runs` timings of parse(), in seconds
+template <typename Parse>
+static double bestOf(int runs, Parse parse) {
+    double best = 1e30;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        parse();
+        best = std::min(best, secondsSince(start));
+    }
+    return best;
+}
+
+static void reportRate(const char* label, double seconds, size_t count) {
+    std::printf("%-12s %8.1f ns/msg  %6.2f M msgs/s per core\n", label, seconds / count * 1e9, count / seconds / 1e6);
+}
+
+static bool sameTelemetry(const Net::Telemetry& a, const Net::Telemetry& b) {
+    return a.fps == b.fps && a.throttle == b.throttle && a.steer == b.steer && a.handbrake == b.handbrake;
+}
+
+static int parseBench(int count) {
+    // Messages as game.js writes them, back to back in one buffer, and the same as masked frames
+    std::string text, frames;
+    std::vector<std::pair<size_t, size_t>> spans;
+    char payload[Net::TELEMETRY_JSON_MAX];
+    uint32_t seed = 12345;
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        Net::Telemetry t;
+        t.fps = 30 + (int32_t)(seed >> 26);
+        t.throttle = (int32_t)((seed >> 8) % 201);
+        t.steer = (int32_t)((seed >> 4) % 3) - 1;
+        t.handbrake = (seed & 7) == 0;
+        const size_t length = Net::formatTelemetry(t, payload);
+        spans.emplace_back(text.size(), length);
+        text.append(payload, length);
+        const uint8_t key[4] = { (uint8_t)seed, (uint8_t)(seed >> 8), (uint8_t)(seed >> 16), (uint8_t)(seed >> 24) };
+        char header[2] = { (char)(0x80 | Net::OP_TEXT), (char)(0x80 | length) };
+        frames.append(header, 2);
+        frames.append((const char*)key, 4);
+        Net::applyMask(&payload[0], length, key);
+        frames.append(payload, length);
+    }
+    std::printf("%d messages, %.1f bytes each\n", count, (double)text.size() / count);
+
+    std::vector<Net::Telemetry> scanned(count), general(count);
+    size_t misses = 0;
+    const double scan = bestOf(5, [&] {
+        misses = 0;
+        for (int i = 0; i < count; ++i) misses += !Net::scanTelemetry(text.data() + spans[i].first, spans[i].second, scanned[i]);
+    });
+    reportRate("scan", scan, count);
+    const double reader = bestOf(5, [&] {
+        for (int i = 0; i < count; ++i) {
+            Net::parseTelemetry(std::string_view(text.data() + spans[i].first, spans[i].second), general[i]);
+        }
+    });
+    reportRate("Json::Reader", reader, count);
+
+    // The server's whole per-message CPU short of the syscalls: decode and unmask, scan, reply
+    std::string replies(count * (Net::TELEMETRY_JSON_MAX + Net::MAX_FRAME_HEADER), '\0');
+    std::string work;
+    double frame = 1e30;
+    size_t decoded = 0;
+    for (int r = 0; r < 5; ++r) {
+        work = frames;
+        auto start = std::chrono::steady_clock::now();
+        char* out = &replies[0];
+        size_t at = 0;
+        decoded = 0;
+        for (;;) {
+            Net::Frame f;
+            uint16_t error;
+            const size_t n = Net::decodeFrame(&work[at], work.size() - at, 1 << 16, f, error);
+            if (n == 0) break;
+            at += n;
+            Net::Telemetry t;
+            if (!Net::scanTelemetry(f.payload, f.length, t)) Net::parseTelemetry(std::string_view(f.payload, f.length), t);
+            char* body = out + Net::MAX_FRAME_HEADER;
+            const size_t length = Net::formatTelemetry(t, body);
+            out += Net::encodeFrameHeader(Net::OP_TEXT, length, out);
+            std::memmove(out, body, length);
+            out += length;
+            decoded++;
+        }
+        frame = std::min(frame, secondsSince(start));
+    }
+    reportRate("frame+reply", frame, decoded);
+
+    bool same = misses == 0 && decoded == (size_t)count;
+    for (int i = 0; same && i < count; ++i) same = sameTelemetry(scanned[i], general[i]);
+
+    // Shapes the scan must hand over, and the general path must still read
+    const char* const others[] = {
+        "{ \"fps\": 60, \"throttle\": 120, \"steer\": 0, \"handbrake\": false }",
+        "{\"throttle\":120,\"fps\":60,\"steer\":0,\"handbrake\":false}",
+        "{\"fps\":59.5,\"throttle\":120,\"steer\":0,\"handbrake\":false}",
+        "{\"fps\":60,\"throttle\":1234567890,\"steer\":0,\"handbrake\":false}",
+        "{\"fps\":60,\"throttle\":120,\"steer\":0}",
+        "{\"fps\":60,\"throttle\":120,\"steer\":0,\"handbrake\":false,\"lap\":3}"
+    };
+    for (const char* other : others) {
+        Net::Telemetry t;
+        same = same && !Net::scanTelemetry(other, std::strlen(other), t) && Net::parseTelemetry(other, t);
+    }
+#if HW_HAS_NLOHMANN_JSON
+    std::vector<Net::Telemetry> reference(count);
+    const double dom = bestOf(3, [&] {
+        for (int i = 0; i < count; ++i) {
+            nlohmann::json j = nlohmann::json::parse(text.begin() + spans[i].first,
+                                                     text.begin() + spans[i].first + spans[i].second);
+            Net::Telemetry& t = reference[i];
+            t.fps = j.value("fps", 0);
+            t.throttle = j.value("throttle", 0);
+            t.steer = j.value("steer", 0);
+            t.handbrake = j.value("handbrake", false);
+        }
+    });
+    reportRate("nlohmann", dom, count);
+    for (int i = 0; same && i < count; ++i) same = sameTelemetry(scanned[i], reference[i]);
+    std::printf("scan %.1fx Json::Reader, %.1fx nlohmann; ", reader / scan, dom / scan);
+#else
+    std::printf("scan %.1fx Json::Reader; ", reader / scan);
+#endif
+    std::printf("results %s\n", same ? "identical" : "DIFFER");
+    return same ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#else
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    std::signal(SIGINT, stopRunning);
+    std::signal(SIGTERM, stopRunning);
+
+    if (argc >= 2 && std::string(argv[1]) == "--parse-bench") {
+        return parseBench(argc >= 3 ? std::max(1, std::atoi(argv[2])) : 1000000);
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--bench") {
+        return bench(argc >= 3 ? std::atoi(argv[2]) : 9002, argc >= 4 ? std::max(1, std::atoi(argv[3])) : 10000,
+                     argc >= 5 ? std::max(1.0, std::atof(argv[4])) : 10.0);
+    }
+    int port = 9002;
+    int threads = std::max(1, (int)std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] != '-') {
+            port = std::atoi(arg.c_str());
+        } else {
+            std::fprintf(stderr, "Usage: %s [port] [--threads n] | --bench [port] [clients] [seconds]"
+                                 " | --parse-bench [messages]\n", argv[0]);
+            return 1;
+        }
+    }
+    return serve(port, threads);
+}
@@ -0,0 +1,244 @@
+// state_hash.h
+// Per-tick state hashing for catching determinism divergence
+// XXH64 (streaming) over the quantized SoA state of one game, split by subsystem
+
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "highway_sim.h"
+
+namespace Sim {
+
+// Streaming XXH64, byte-compatible with the reference implementation
+class XXH64 {
+private:
+    static const uint64_t P1 = 11400714785074694791ull;
+    static const uint64_t P2 = 14029467366897019727ull;
+    static const uint64_t P3 = 1609587929392839161ull;
+    static const uint64_t P4 = 9650029242287828579ull;
+    static const uint64_t P5 = 2870177450012600261ull;
+
+    uint64_t v1, v2, v3, v4, seed;
+    uint64_t totalLen;
+    unsigned char buffer[32];
+    size_t bufferLen;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+    static uint64_t read64(const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    static uint32_t read32(const unsigned char* p) { uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * P2;
+        acc = rotl(acc, 31);
+        return acc * P1;
+    }
+
+    static uint64_t mergeRound(uint64_t acc, uint64_t val) {
+        acc ^= round(0, val);
+        return acc * P1 + P4;
+    }
+
+    void consumeStripe(const unsigned char* p) {
+        v1 = round(v1, read64(p));
+        v2 = round(v2, read64(p + 8));
+        v3 = round(v3, read64(p + 16));
+        v4 = round(v4, read64(p + 24));
+    }
+
+public:
+    explicit XXH64(uint64_t s = 0) { reset(s); }
+
+    void reset(uint64_t s) {
+        seed = s;
+        v1 = s + P1 + P2;
+        v2 = s + P2;
+        v3 = s;
+        v4 = s - P1;
+        totalLen = 0;
+        bufferLen = 0;
+    }
+
+    void update(const void* data, size_t len) {
+        const unsigned char* p = (const unsigned char*)data;
+        totalLen += len;
+        if (bufferLen + len < 32) {
+            std::memcpy(buffer + bufferLen, p, len);
+            bufferLen += len;
+            return;
+        }
+        if (bufferLen > 0) {
+            size_t fill = 32 - bufferLen;
+            std::memcpy(buffer + bufferLen, p, fill);
+            consumeStripe(buffer);
+            p += fill;
+            len -= fill;
+            bufferLen = 0;
+        }
+        while (len >= 32) {
+            consumeStripe(p);
+            p += 32;
+            len -= 32;
+        }
+        std::memcpy(buffer, p, len);
+        bufferLen = len;
+    }
+
+    uint64_t digest() const {
+        uint64_t h;
+        if (totalLen >= 32) {
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = mergeRound(h, v1);
+            h = mergeRound(h, v2);
+            h = mergeRound(h, v3);
+            h = mergeRound(h, v4);
+        } else {
+            h = seed + P5;
+        }
+        h += totalLen;
+
+        const unsigned char* p = buffer;
+        size_t len = bufferLen;
+        while (len >= 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * P1 + P4;
+            p += 8;
+            len -= 8;
+        }
+        if (len >= 4) {
+            h ^= (uint64_t)read32(p) * P1;
+            h = rotl(h, 23) * P2 + P3;
+            p += 4;
+            len -= 4;
+        }
+        while (len > 0) {
+            h ^= (*p) * P5;
+            h = rotl(h, 11) * P1;
+            p++;
+            len--;
+        }
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    static uint64_t hash(const void* data, size_t len, uint64_t s = 0) {
+        XXH64 h(s);
+        h.update(data, len);
+        return h.digest();
+    }
+};
+
+// Subsystems hashed separately so a divergence can be attributed
+enum HashSubsystem {
+    HASH_PLAYER = 0,
+    HASH_TRAFFIC,
+    HASH_PROGRESS,
+    HASH_RNG,
+    HASH_ITEMS,
+    HASH_SUBSYSTEM_COUNT
+};
+
+inline const char* hashSubsystemName(int subsystem) {
+    static const char* names[HASH_SUBSYSTEM_COUNT] = { "player", "traffic", "progress", "rng", "items" };
+    return (subsystem >= 0 && subsystem < HASH_SUBSYSTEM_COUNT) ? names[subsystem] : "unknown";
+}
+
+// Positions are compared at 1/256 px: differences below that are rounding noise, not desyncs
+const float HASH_QUANT_SCALE = 256.0f;
+
+// Values past ±8M px (distance and score in long or warped runs) saturate instead of overflowing
+// the conversion; NaN hashes as 0
+inline int32_t quantize(float v) {
+    const float q = std::floor(v * HASH_QUANT_SCALE + 0.5f);
+    if (q >= 2147483648.0f) return INT32_MAX;
+    if (q >= -2147483648.0f) return (int32_t)q;
+    return q == q ? INT32_MIN : 0;
+}
+
+// Fixed point is already exact; drop the bits below 1/256 the same way
+inline int32_t quantize(Fixed v) {
+    const int64_t q = v.raw >> (Fixed::FRAC_BITS - 8);
+    return q > INT32_MAX ? INT32_MAX : q < INT32_MIN ? INT32_MIN : (int32_t)q;
+}
+
+// Hash one scalar column of a game's vehicle span without allocating
+inline void hashColumn(XXH64& h, const Scalar* values, int count) {
+    int32_t chunk[64];
+    for (int i = 0; i < count; i += 64) {
+        int n = std::min(64, count - i);
+        for (int k = 0; k < n; ++k) chunk[k] = quantize(values[i + k]);
+        h.update(chunk, sizeof(int32_t) * n);
+    }
+}
+
+// Hash the quantized state of game g. Each subsystem hash is chained onto the previous
+// tick's value (passed in via `chain`), so once two runs diverge they never hash equal again.
+inline void hashGameState(const World& w, int g, uint64_t chain[HASH_SUBSYSTEM_COUNT]) {
+    XXH64 h(chain[HASH_PLAYER]);
+    int32_t player[6] = {
+        quantize(w.playerX[g]), quantize(w.playerSpeed[g]),
+        w.playerLane[g], w.playerTargetLane[g], w.playerChangingLane[g], w.crashed[g]
+    };
+    h.update(player, sizeof(player));
+    chain[HASH_PLAYER] = h.digest();
+
+    h.reset(chain[HASH_TRAFFIC]);
+    const int begin = w.slotBegin(g), count = w.trafficCount[g];
+    h.update(&count, sizeof(count));
+    hashColumn(h, &w.vehX[begin], count);
+    hashColumn(h, &w.vehY[begin], count);
+    hashColumn(h, &w.vehSpeed[begin], count);
+    hashColumn(h, &w.vehOscillation[begin], count);
+    h.update(&w.vehLane[begin], sizeof(int) * count);
+    h.update(&w.vehType[begin], sizeof(int) * count);
+    // Driver state, so an FSM or lane-change divergence is caught on its own tick rather than
+    // once it has moved a car
+    hashColumn(h, &w.vehBaseSpeed[begin], count);
+    hashColumn(h, &w.vehAggression[begin], count);
+    hashColumn(h, &w.vehLateralShift[begin], count);
+    hashColumn(h, &w.vehLateralProgress[begin], count);
+    h.update(&w.vehTargetLane[begin], sizeof(int) * count);
+    h.update(&w.vehAiState[begin], count);
+    h.update(&w.vehChangingLane[begin], count);
+    chain[HASH_TRAFFIC] = h.digest();
+
+    h.reset(chain[HASH_PROGRESS]);
+    int32_t progress[9] = {
+        quantize(w.score[g]), quantize(w.distance[g]), quantize(w.roadSpeed[g]),
+        quantize(w.chunkPos[g]), quantize(w.maxSpeed[g]), w.level[g], (int32_t)w.ticks[g],
+        (int32_t)w.chunkIndex[g], w.chunkCursor[g]
+    };
+    h.update(progress, sizeof(progress));
+    chain[HASH_PROGRESS] = h.digest();
+
+    h.reset(chain[HASH_RNG]);
+    h.update(&w.rng[g].state, sizeof(w.rng[g].state));
+    chain[HASH_RNG] = h.digest();
+
+    // Items oldest first per lane, so ring positions don't matter
+    h.reset(chain[HASH_ITEMS]);
+    int32_t effects[3] = { quantize(w.itemRowPos[g]), w.nitroActive[g], w.shieldActive[g] };
+    h.update(effects, sizeof(effects));
+    h.update(&w.itemRng[g].state, sizeof(w.itemRng[g].state));
+    for (int lane = 0; lane < w.params.lanes; ++lane) {
+        const int ring = w.itemRing(g, lane);
+        h.update(&w.itemCount[ring], sizeof(int));
+        for (int k = 0; k < w.itemCount[ring]; ++k) {
+            const int slot = w.itemRingSlot(ring, k);
+            int32_t item[2] = { quantize(w.itemYAt(g, slot)), w.itemType[slot] };
+            h.update(item, sizeof(item));
+        }
+    }
+    chain[HASH_ITEMS] = h.digest();
+}
+
+} // namespace Sim
+
+#endif // STATE_HASH_H
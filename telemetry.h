@@ -0,0 +1,202 @@
+// telemetry.h
+// The web client's per-frame debug message (game.js): {fps, throttle, steer, handbrake}
+// JSON.stringify always writes the same four keys in the same order, so scanTelemetry() reads
+// that exact shape straight out of the frame buffer into a plain record: one vector pass finds the
+// ':' and ',' positions, the keys between them are compared whole and the values parsed in place.
+// Anything else goes to parseTelemetry(), the general Json::Reader path. Replies are written back
+// in the same shape for game.js's onmessage. Header-only, no dependencies.
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include "json_reader.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HW_TELEMETRY_SSE2 1
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Net {
+
+// Missing keys read as zero / false, like game.js's `data.throttle || 0`
+struct Telemetry {
+    int32_t fps;
+    int32_t throttle;
+    int32_t steer;
+    uint8_t handbrake;
+};
+
+// game.js sends whole numbers (null reads as 0); anything else is truncated into int32 range
+inline bool readTelemetryNumber(Json::Reader& r, int32_t& value) {
+    if (r.peek() == Json::Reader::NULL_VALUE) {
+        value = 0;
+        return r.skipValue();
+    }
+    double v;
+    if (!r.readNumber(v)) return false;
+    if (!std::isfinite(v)) return r.reject("number out of range");
+    v = v < -2147483648.0 ? -2147483648.0 : v > 2147483647.0 ? 2147483647.0 : v;
+    value = (int32_t)v;
+    return true;
+}
+
+// Any JSON object; unknown keys are skipped, and any field may be null (game.js sends
+// `fps: null` on a zero-length frame)
+inline bool parseTelemetry(std::string_view text, Telemetry& t) {
+    t = Telemetry();
+    Json::Reader r(text);
+    std::string_view key;
+    bool handbrake = false;
+    r.beginObject();
+    while (r.nextMember(key)) {
+        if (key == "fps") readTelemetryNumber(r, t.fps);
+        else if (key == "throttle") readTelemetryNumber(r, t.throttle);
+        else if (key == "steer") readTelemetryNumber(r, t.steer);
+        else if (key == "handbrake" && r.peek() == Json::Reader::BOOL) {
+            r.readBool(handbrake);
+            t.handbrake = handbrake;
+        } else {
+            r.skipValue();
+        }
+    }
+    return r.ok() && r.atEnd();
+}
+
+// Index of the lowest set bit of a non-zero mask
+inline int lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    int index = 0;
+    while (!(mask & 1)) mask >>= 1, index++;
+    return index;
+#endif
+}
+
+// Bit i set where text[i] is ':' (colons) or ',' (commas), for up to 64 bytes. Sixteen bytes per
+// compare where SSE2 is available; the tail, and everything elsewhere, a byte at a time
+inline void structuralMasks(const char* text, size_t length, uint64_t& colons, uint64_t& commas) {
+    colons = commas = 0;
+    size_t i = 0;
+#if HW_TELEMETRY_SSE2
+    const __m128i colon = _mm_set1_epi8(':'), comma = _mm_set1_epi8(',');
+    for (; i + 16 <= length; i += 16) {
+        const __m128i block = _mm_loadu_si128((const __m128i*)(text + i));
+        colons |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, colon)) << i;
+        commas |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, comma)) << i;
+    }
+#endif
+    for (; i < length; ++i) {
+        colons |= (uint64_t)(text[i] == ':') << i;
+        commas |= (uint64_t)(text[i] == ',') << i;
+    }
+}
+
+// Exactly `count` set bits, written to positions[] from lowest
+inline bool maskPositions(uint64_t mask, size_t* positions, int count) {
+    for (int k = 0; k < count; ++k) {
+        if (!mask) return false;
+        positions[k] = (size_t)lowestBit(mask);
+        mask &= mask - 1;
+    }
+    return mask == 0;
+}
+
+// Optional '-' and 1..9 digits; longer numbers take the general path
+inline bool scanInt(const char* text, size_t length, int32_t& value) {
+    const bool negative = length > 0 && text[0] == '-';
+    if (negative) text++, length--;
+    if (length == 0 || length > 9) return false;
+    int32_t v = 0;
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned digit = (unsigned char)text[i] - (unsigned)'0';
+        if (digit > 9) return false;
+        v = v * 10 + (int32_t)digit;
+    }
+    value = negative ? -v : v;
+    return true;
+}
+
+// The shortest and longest messages scanTelemetry takes
+const size_t TELEMETRY_SCAN_MIN = 49; // {"fps":0,"throttle":0,"steer":0,"handbrake":true}
+const size_t TELEMETRY_SCAN_MAX = 64;
+
+// {"fps":N,"throttle":N,"steer":N,"handbrake":true|false} with no whitespace, as JSON.stringify
+// writes it. False for any other text, which parseTelemetry() then reads. Everything it accepts
+// is ASCII, so it needs no UTF-8 check either.
+inline bool scanTelemetry(const char* text, size_t length, Telemetry& t) {
+    if (length < TELEMETRY_SCAN_MIN || length > TELEMETRY_SCAN_MAX) return false;
+    uint64_t colons, commas;
+    structuralMasks(text, length, colons, commas);
+    size_t colon[4], comma[3];
+    if (!maskPositions(colons, colon, 4) || !maskPositions(commas, comma, 3)) return false;
+
+    // Each key runs from the previous comma (or the brace) to its colon
+    if (colon[0] != 6 || std::memcmp(text, "{\"fps\"", 6) != 0
+        || colon[1] != comma[0] + 11 || std::memcmp(text + comma[0], ",\"throttle\"", 11) != 0
+        || colon[2] != comma[1] + 8 || std::memcmp(text + comma[1], ",\"steer\"", 8) != 0
+        || colon[3] != comma[2] + 12 || std::memcmp(text + comma[2], ",\"handbrake\"", 12) != 0) {
+        return false;
+    }
+    if (comma[0] < colon[0] || comma[1] < colon[1] || comma[2] < colon[2]
+        || !scanInt(text + colon[0] + 1, comma[0] - colon[0] - 1, t.fps)
+        || !scanInt(text + colon[1] + 1, comma[1] - colon[1] - 1, t.throttle)
+        || !scanInt(text + colon[2] + 1, comma[2] - colon[2] - 1, t.steer)) {
+        return false;
+    }
+    const char* last = text + colon[3] + 1;
+    const size_t lastLength = length - colon[3] - 1;
+    if (lastLength == 5 && std::memcmp(last, "true}", 5) == 0) t.handbrake = 1;
+    else if (lastLength == 6 && std::memcmp(last, "false}", 6) == 0) t.handbrake = 0;
+    else return false;
+    return true;
+}
+
+// Room for the longest message formatTelemetry writes
+const size_t TELEMETRY_JSON_MAX = 96;
+
+inline char* writeInt(char* out, int32_t value) {
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    if (value < 0) *out++ = '-';
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    while (n) *out++ = digits[--n];
+    return out;
+}
+
+// {"fps":..,"throttle":..,"steer":..,"handbrake":..} into `out`; returns its length
+inline size_t formatTelemetry(const Telemetry& t, char* out) {
+    char* p = out;
+    auto put = [&p](const char* text, size_t length) {
+        for (size_t i = 0; i < length; ++i) *p++ = text[i];
+    };
+    put("{\"fps\":", 7);
+    p = writeInt(p, t.fps);
+    put(",\"throttle\":", 12);
+    p = writeInt(p, t.throttle);
+    put(",\"steer\":", 9);
+    p = writeInt(p, t.steer);
+    if (t.handbrake) put(",\"handbrake\":true}", 18);
+    else put(",\"handbrake\":false}", 19);
+    return (size_t)(p - out);
+}
+
+} // namespace Net
+
+#endif // TELEMETRY_H
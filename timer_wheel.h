@@ -0,0 +1,202 @@
+// timer_wheel.h
+// Hierarchical timing wheel for tick-based expiries (item effects, cooldowns)
+// Scheduling and cancelling are O(1); advancing one tick only touches the timers due then (plus,
+// every 64 ticks, one coarser slot cascading down), so the cost follows the number of timers
+// firing rather than the number alive. No SFML dependency.
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Sim {
+
+// Names one scheduled timer. Slots are recycled, so a handle also carries the slot's generation
+// and goes stale once its timer fires or is cancelled.
+struct TimerHandle {
+    int index = -1;
+    uint32_t generation = 0;
+};
+
+// LEVELS wheels of SLOTS slots each; level L slots are SLOTS^L ticks wide. A timer sits in the
+// coarsest level its delay needs and drops a level each time its slot comes round, landing in
+// level 0 exactly on its tick. Delays past the top level's span park in the top level and are
+// re-placed when they cascade.
+//
+// Timers due in the same tick fire in the order they were scheduled, so a fixed-step sim that
+// schedules deterministically also expires deterministically.
+class TimerWheel {
+private:
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4; // 2^24 ticks, about 78 hours at 60 Hz, before parking
+
+    enum TimerState : uint8_t { TIMER_FREE = 0, TIMER_LINKED, TIMER_FIRING };
+
+    struct Timer {
+        uint64_t due;
+        uint64_t sequence; // schedule order, for same-tick ordering
+        uint32_t payload;
+        uint32_t generation;
+        int prev, next;    // slot list, or `next` in the free list
+        int bucket;        // level * SLOTS + slot while linked
+        uint8_t state;
+    };
+
+    std::vector<Timer> timers;
+    int bucketHead[LEVELS * SLOTS];
+    std::vector<int> expired; // scratch for the timers firing this tick
+    int freeList = -1;
+    int active = 0;
+    uint64_t now = 0;
+    uint64_t nextSequence = 0;
+
+    int allocate() {
+        if (freeList < 0) {
+            timers.push_back(Timer());
+            timers.back().generation = 0;
+            return (int)timers.size() - 1;
+        }
+        int t = freeList;
+        freeList = timers[t].next;
+        return t;
+    }
+
+    void release(int t) {
+        timers[t].state = TIMER_FREE;
+        timers[t].generation++;
+        timers[t].next = freeList;
+        freeList = t;
+        active--;
+    }
+
+    static int bucketFor(uint64_t due, uint64_t tick) {
+        const uint64_t delay = due - tick;
+        for (int level = 0; level < LEVELS; ++level) {
+            if (delay < (1ull << (SLOT_BITS * (level + 1)))) {
+                return level * SLOTS + (int)((due >> (SLOT_BITS * level)) & (SLOTS - 1));
+            }
+        }
+        // Too far out: the top-level slot that cascades last in this revolution
+        const int top = LEVELS - 1;
+        return top * SLOTS + (int)(((tick >> (SLOT_BITS * top)) + SLOTS - 1) & (SLOTS - 1));
+    }
+
+    void link(int t) {
+        Timer& timer = timers[t];
+        timer.bucket = bucketFor(timer.due, now);
+        timer.prev = -1;
+        timer.next = bucketHead[timer.bucket];
+        if (timer.next >= 0) timers[timer.next].prev = t;
+        bucketHead[timer.bucket] = t;
+        timer.state = TIMER_LINKED;
+    }
+
+    void unlink(int t) {
+        Timer& timer = timers[t];
+        if (timer.prev >= 0) timers[timer.prev].next = timer.next;
+        else bucketHead[timer.bucket] = timer.next;
+        if (timer.next >= 0) timers[timer.next].prev = timer.prev;
+    }
+
+    // Re-place every timer of one coarse slot relative to the current tick
+    void cascade(int bucket) {
+        int t = bucketHead[bucket];
+        bucketHead[bucket] = -1;
+        while (t >= 0) {
+            const int next = timers[t].next;
+            link(t);
+            t = next;
+        }
+    }
+
+public:
+    TimerWheel() { clear(0); }
+
+    // Drop every timer and restart the clock at `tick`. Outstanding handles go stale
+    void clear(uint64_t tick) {
+        for (int b = 0; b < LEVELS * SLOTS; ++b) bucketHead[b] = -1;
+        freeList = -1;
+        for (int t = (int)timers.size() - 1; t >= 0; --t) {
+            if (timers[t].state != TIMER_FREE) timers[t].generation++;
+            timers[t].state = TIMER_FREE;
+            timers[t].next = freeList;
+            freeList = t;
+        }
+        active = 0;
+        now = tick;
+        nextSequence = 0;
+    }
+
+    int size() const { return active; }
+    uint64_t currentTick() const { return now; }
+
+    // Fire `payload` when the wheel reaches tick `due`; past ticks fire on the next advance
+    TimerHandle schedule(uint64_t due, uint32_t payload) {
+        if (due <= now) due = now + 1;
+        int t = allocate();
+        timers[t].due = due;
+        timers[t].sequence = nextSequence++;
+        timers[t].payload = payload;
+        link(t);
+        active++;
+        TimerHandle handle;
+        handle.index = t;
+        handle.generation = timers[t].generation;
+        return handle;
+    }
+
+    bool pending(TimerHandle handle) const {
+        return handle.index >= 0 && handle.index < (int)timers.size()
+            && timers[handle.index].generation == handle.generation && timers[handle.index].state != TIMER_FREE;
+    }
+
+    // Returns false if the timer already fired or was cancelled. A timer due this tick can
+    // still be cancelled from another timer's callback
+    bool cancel(TimerHandle handle) {
+        if (!pending(handle)) return false;
+        if (timers[handle.index].state == TIMER_LINKED) unlink(handle.index);
+        release(handle.index);
+        return true;
+    }
+
+    // Move to the next tick and call fire(payload) for every timer due then
+    template <typename Fire>
+    void advance(Fire fire) {
+        now++;
+        if (active == 0) return; // every slot is empty, so there is nothing to cascade or fire
+
+        // Coarser slots whose span starts now move down, the coarsest first
+        int levels = 0;
+        while (levels + 1 < LEVELS && (now & ((1ull << (SLOT_BITS * (levels + 1))) - 1)) == 0) levels++;
+        for (int level = levels; level >= 1; --level) {
+            cascade(level * SLOTS + (int)((now >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+
+        const int bucket = (int)(now & (SLOTS - 1));
+        expired.clear();
+        for (int t = bucketHead[bucket]; t >= 0; t = timers[t].next) {
+            timers[t].state = TIMER_FIRING;
+            expired.push_back(t);
+        }
+        bucketHead[bucket] = -1;
+        if (expired.size() > 1) {
+            std::sort(expired.begin(), expired.end(),
+                      [this](int a, int b) { return timers[a].sequence < timers[b].sequence; });
+        }
+        // Callbacks may schedule or cancel timers, including ones later in this batch
+        for (size_t k = 0; k < expired.size(); ++k) {
+            const int t = expired[k];
+            if (timers[t].state != TIMER_FIRING) continue;
+            const uint32_t payload = timers[t].payload;
+            release(t);
+            fire(payload);
+        }
+    }
+};
+
+} // namespace Sim
+
+#endif // TIMER_WHEEL_H
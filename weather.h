@@ -0,0 +1,100 @@
+// weather.h
+// Rain and fog for the native game, following an environment's weather schedule (env_generator.h)
+// Weather is visual only: the sim never reads it, so it cannot change physics or replays. Rain is
+// a fixed pool of streaks kept as separate coordinate arrays and moved by one branch-free loop that
+// the compiler vectorizes. No SFML dependency.
+
+#ifndef WEATHER_H
+#define WEATHER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "env_generator.h"
+
+namespace Sim {
+
+// Spells fade in and out over this many ticks, so back-to-back spells meet at zero
+const uint32_t WEATHER_FADE_TICKS = 3 * 60;
+
+// How strong rain and fog are right now, 0..1 each
+struct WeatherLevels {
+    float rain = 0.0f;
+    float fog = 0.0f;
+};
+
+inline WeatherLevels weatherLevels(const EnvTables& tables, uint64_t tick) {
+    WeatherLevels levels;
+    const WeatherSpell& spell = tables.weatherAt(tick);
+    if (spell.kind == WEATHER_CLEAR) return levels;
+    const uint32_t into = (uint32_t)(tick % tables.weatherCycleTicks) - spell.startTick;
+    const uint32_t edge = std::min(into, spell.ticks - into);
+    const float level = spell.intensity * std::min(1.0f, (float)edge / WEATHER_FADE_TICKS);
+    if (spell.kind == WEATHER_RAIN) levels.rain = level;
+    else levels.fog = level;
+    return levels;
+}
+
+// Move a span of streaks and wrap them back into the width x height screen. Nearer streaks (depth
+// toward 1) fall and drift faster. A frame's step is under one screen, so the wrap is a truncated
+// divide instead of compares, which keeps the loop vectorizable without fast-math.
+inline void updateRainSpan(float* __restrict x, float* __restrict y, const float* __restrict depth, int count,
+                           float fall, float drift, float width, float height) {
+    const float invWidth = 1.0f / width, invHeight = 1.0f / height;
+    for (int i = 0; i < count; ++i) {
+        const float nx = x[i] + drift * depth[i] + width; // 0..3 widths
+        const float ny = y[i] + fall * depth[i];          // 0..2 heights
+        x[i] = nx - width * (float)(int)(nx * invWidth);
+        y[i] = ny - height * (float)(int)(ny * invHeight);
+    }
+}
+
+// Streaks kept in the pool; a multiple of the SIMD width so the active span stays whole vectors
+const int RAIN_MAX_STREAKS = 12288;
+
+// Screen-space rain. Every streak is placed once; intensity only changes how many of them are
+// live, so a spell fading in or out never reallocates or reshuffles.
+class RainField {
+private:
+    std::vector<float> x, y, depth;
+    float width, height;
+    int active;
+
+public:
+    RainField(float screenWidth, float screenHeight, uint64_t seed = 0x7261696eull)
+        : x(RAIN_MAX_STREAKS), y(RAIN_MAX_STREAKS), depth(RAIN_MAX_STREAKS), width(1), height(1), active(0) {
+        Rng rng(seed);
+        for (int i = 0; i < RAIN_MAX_STREAKS; ++i) depth[i] = rng.range(0.35f, 1.0f);
+        resize(screenWidth, screenHeight, seed);
+    }
+
+    // Scatter the streaks over a new screen size
+    void resize(float screenWidth, float screenHeight, uint64_t seed = 0x7261696eull) {
+        width = std::max(1.0f, screenWidth);
+        height = std::max(1.0f, screenHeight);
+        Rng rng(seed ^ 0x706f73ull);
+        for (int i = 0; i < RAIN_MAX_STREAKS; ++i) {
+            x[i] = rng.range(0.0f, width);
+            y[i] = rng.range(0.0f, height);
+        }
+    }
+
+    void setIntensity(float intensity) {
+        const int wanted = (int)(std::min(1.0f, std::max(0.0f, intensity)) * RAIN_MAX_STREAKS);
+        active = (wanted + 7) & ~7;
+    }
+
+    // `fall` and `drift` are pixels per frame for the nearest streaks
+    void update(float fall, float drift) {
+        updateRainSpan(x.data(), y.data(), depth.data(), active, fall, drift, width, height);
+    }
+
+    int size() const { return active; }
+    const float* xs() const { return x.data(); }
+    const float* ys() const { return y.data(); }
+    const float* depths() const { return depth.data(); }
+};
+
+} // namespace Sim
+
+#endif // WEATHER_H
@@ -0,0 +1,319 @@
+// websocket.h
+// RFC 6455 server side: the opening handshake and frame encoding and decoding
+// Pure byte-buffer code with no sockets, so the event loop (server.cpp) owns all I/O. Frames are
+// decoded and unmasked in place in the receive buffer, so a message's payload is a view into the
+// bytes the socket delivered. Header-only, no dependencies.
+
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace Net {
+
+enum Opcode : uint8_t {
+    OP_CONTINUATION = 0x0,
+    OP_TEXT = 0x1,
+    OP_BINARY = 0x2,
+    OP_CLOSE = 0x8,
+    OP_PING = 0x9,
+    OP_PONG = 0xA
+};
+
+enum CloseCode : uint16_t {
+    CLOSE_NORMAL = 1000,
+    CLOSE_GOING_AWAY = 1001,
+    CLOSE_PROTOCOL_ERROR = 1002,
+    CLOSE_UNSUPPORTED_DATA = 1003,
+    CLOSE_INVALID_DATA = 1007,
+    CLOSE_POLICY = 1008,
+    CLOSE_TOO_BIG = 1009
+};
+
+// Codes a peer may send in a close frame (section 7.4)
+inline bool validCloseCode(uint16_t code) {
+    return (code >= 1000 && code <= 1003) || (code >= 1007 && code <= 1011) || (code >= 3000 && code <= 4999);
+}
+
+// SHA-1, only for Sec-WebSocket-Accept
+inline void sha1(const void* data, size_t length, uint8_t digest[20]) {
+    uint32_t h[5] = { 0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u };
+    auto rotl = [](uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+    const uint8_t* bytes = (const uint8_t*)data;
+    const uint64_t bits = (uint64_t)length * 8;
+    uint8_t block[64];
+    for (size_t offset = 0; offset <= length + 8; offset += 64) {
+        // The message, then 0x80, zeros and the bit length in the last eight bytes
+        for (int i = 0; i < 64; ++i) {
+            const size_t at = offset + (size_t)i;
+            block[i] = at < length ? bytes[at] : at == length ? 0x80 : 0;
+        }
+        if (offset + 64 >= length + 9) {
+            for (int i = 0; i < 8; ++i) block[63 - i] = (uint8_t)(bits >> (8 * i));
+        }
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16
+                 | (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+        }
+        for (int i = 16; i < 80; ++i) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) f = (b & c) | (~b & d), k = 0x5A827999u;
+            else if (i < 40) f = b ^ c ^ d, k = 0x6ED9EBA1u;
+            else if (i < 60) f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDCu;
+            else f = b ^ c ^ d, k = 0xCA62C1D6u;
+            const uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 20; ++i) digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+inline std::string base64(const uint8_t* data, size_t length) {
+    static const char DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < length; i += 3) {
+        const uint32_t n = (uint32_t)data[i] << 16 | (i + 1 < length ? (uint32_t)data[i + 1] << 8 : 0)
+                         | (i + 2 < length ? data[i + 2] : 0);
+        out += DIGITS[n >> 18];
+        out += DIGITS[(n >> 12) & 63];
+        out += i + 1 < length ? DIGITS[(n >> 6) & 63] : '=';
+        out += i + 2 < length ? DIGITS[n & 63] : '=';
+    }
+    return out;
+}
+
+// Sec-WebSocket-Accept for a client's Sec-WebSocket-Key
+inline std::string websocketAccept(std::string_view key) {
+    std::string text(key);
+    text += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[20];
+    sha1(text.data(), text.size(), digest);
+    return base64(digest, sizeof(digest));
+}
+
+// Requests past this size without a blank line are refused
+const size_t MAX_HANDSHAKE_BYTES = 8192;
+
+enum HandshakeResult {
+    HANDSHAKE_INCOMPLETE, // need more bytes
+    HANDSHAKE_ACCEPTED,   // `response` is the 101; the connection speaks frames from here
+    HANDSHAKE_REFUSED     // `response` is an error reply; close after sending it
+};
+
+inline char asciiLower(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (asciiLower(a[i]) != asciiLower(b[i])) return false;
+    }
+    return true;
+}
+
+// Whether a comma-separated header value lists `token`, ignoring case
+inline bool headerHasToken(std::string_view value, std::string_view token) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        std::string_view item = value.substr(0, comma);
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (equalsIgnoreCase(item, token)) return true;
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// The opening handshake at the start of `request`. On a verdict `length` is the size of the
+// request head, so frames sent right behind it are not lost
+inline HandshakeResult parseHandshake(std::string_view request, size_t& length, std::string& response) {
+    const size_t headEnd = request.find("\r\n\r\n");
+    if (headEnd == std::string_view::npos) {
+        if (request.size() < MAX_HANDSHAKE_BYTES) return HANDSHAKE_INCOMPLETE;
+        response = "HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+        length = request.size();
+        return HANDSHAKE_REFUSED;
+    }
+    length = headEnd + 4;
+    std::string_view head = request.substr(0, headEnd + 2);
+
+    size_t lineEnd = head.find("\r\n");
+    std::string_view requestLine = head.substr(0, lineEnd);
+    bool upgrade = false, connectionUpgrade = false, version13 = false;
+    std::string_view key;
+    for (size_t at = lineEnd + 2; at < head.size(); at = lineEnd + 2) {
+        lineEnd = head.find("\r\n", at);
+        std::string_view line = head.substr(at, lineEnd - at);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        std::string_view name = line.substr(0, colon), value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        if (equalsIgnoreCase(name, "Upgrade")) upgrade = headerHasToken(value, "websocket");
+        else if (equalsIgnoreCase(name, "Connection")) connectionUpgrade = headerHasToken(value, "upgrade");
+        else if (equalsIgnoreCase(name, "Sec-WebSocket-Version")) version13 = value == "13";
+        else if (equalsIgnoreCase(name, "Sec-WebSocket-Key")) key = value;
+    }
+
+    if (requestLine.substr(0, 4) != "GET " || requestLine.size() < 9
+        || requestLine.substr(requestLine.size() - 9) != " HTTP/1.1" || !upgrade || !connectionUpgrade
+        || key.size() != 24) {
+        response = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+        return HANDSHAKE_REFUSED;
+    }
+    if (!version13) {
+        response = "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\nConnection: close\r\n"
+                   "Content-Length: 0\r\n\r\n";
+        return HANDSHAKE_REFUSED;
+    }
+    response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+               "Sec-WebSocket-Accept: ";
+    response += websocketAccept(key);
+    response += "\r\n\r\n";
+    return HANDSHAKE_ACCEPTED;
+}
+
+// XOR `length` bytes with the 4-byte mask, where byte i uses key[(phase + i) % 4]. Eight bytes at
+// a time; returns the phase to continue with
+inline size_t applyMask(char* data, size_t length, const uint8_t key[4], size_t phase = 0) {
+    uint8_t rotated[8];
+    for (int i = 0; i < 8; ++i) rotated[i] = key[(phase + (size_t)i) & 3];
+    uint64_t wide;
+    std::memcpy(&wide, rotated, 8);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        word ^= wide;
+        std::memcpy(data + i, &word, 8);
+    }
+    for (; i < length; ++i) data[i] ^= (char)rotated[i & 7];
+    return (phase + length) & 3;
+}
+
+struct Frame {
+    bool fin;
+    uint8_t opcode;
+    char* payload; // unmasked, inside the decoded buffer
+    size_t length;
+};
+
+// Decode the client frame at the start of `data`. Returns the bytes it spans, with its payload
+// unmasked in place, or 0 when the frame is not complete yet. A frame the protocol forbids sets
+// `error` to the close code to fail the connection with (and returns 0).
+inline size_t decodeFrame(char* data, size_t size, size_t maxPayload, Frame& frame, uint16_t& error) {
+    error = 0;
+    if (size < 2) return 0;
+    const uint8_t b0 = (uint8_t)data[0], b1 = (uint8_t)data[1];
+    frame.fin = (b0 & 0x80) != 0;
+    frame.opcode = b0 & 0x0F;
+    const bool control = (frame.opcode & 0x8) != 0;
+    if ((b0 & 0x70) || !(b1 & 0x80)                                     // no extensions; clients mask
+        || (frame.opcode > OP_BINARY && frame.opcode < OP_CLOSE) || frame.opcode > OP_PONG
+        || (control && (!frame.fin || (b1 & 0x7F) > 125))) {
+        error = CLOSE_PROTOCOL_ERROR;
+        return 0;
+    }
+    size_t header = 2;
+    uint64_t length = b1 & 0x7F;
+    if (length == 126) {
+        if (size < 4) return 0;
+        length = (uint64_t)(uint8_t)data[2] << 8 | (uint8_t)data[3];
+        header = 4;
+    } else if (length == 127) {
+        if (size < 10) return 0;
+        length = 0;
+        for (int i = 0; i < 8; ++i) length = length << 8 | (uint8_t)data[2 + i];
+        header = 10;
+        if (length >> 63) {
+            error = CLOSE_PROTOCOL_ERROR;
+            return 0;
+        }
+    }
+    if (length > maxPayload) {
+        error = CLOSE_TOO_BIG;
+        return 0;
+    }
+    if (size < header + 4 + length) return 0;
+    uint8_t key[4];
+    std::memcpy(key, data + header, 4);
+    frame.payload = data + header + 4;
+    frame.length = (size_t)length;
+    applyMask(frame.payload, frame.length, key);
+    return header + 4 + (size_t)length;
+}
+
+// Largest header encodeFrameHeader writes
+const size_t MAX_FRAME_HEADER = 10;
+
+// Header of an unfragmented, unmasked server frame; returns its size
+inline size_t encodeFrameHeader(uint8_t opcode, size_t length, char* out) {
+    out[0] = (char)(0x80 | opcode);
+    if (length < 126) {
+        out[1] = (char)length;
+        return 2;
+    }
+    if (length <= 0xFFFF) {
+        out[1] = 126;
+        out[2] = (char)(length >> 8);
+        out[3] = (char)length;
+        return 4;
+    }
+    out[1] = 127;
+    for (int i = 0; i < 8; ++i) out[2 + i] = (char)((uint64_t)length >> (56 - 8 * i));
+    return 10;
+}
+
+// Well-formed UTF-8 (no overlongs, surrogates or code points past U+10FFFF). ASCII runs are
+// checked eight bytes at a time
+inline bool validUtf8(const char* text, size_t length) {
+    const uint8_t* s = (const uint8_t*)text;
+    size_t i = 0;
+    while (i < length) {
+        if (i + 8 <= length) {
+            uint64_t word;
+            std::memcpy(&word, s + i, 8);
+            if (!(word & 0x8080808080808080ull)) {
+                i += 8;
+                continue;
+            }
+        }
+        const uint8_t c = s[i];
+        if (c < 0x80) {
+            i++;
+            continue;
+        }
+        size_t extra;
+        uint32_t min, code;
+        if ((c & 0xE0) == 0xC0) extra = 1, min = 0x80, code = c & 0x1F;
+        else if ((c & 0xF0) == 0xE0) extra = 2, min = 0x800, code = c & 0x0F;
+        else if ((c & 0xF8) == 0xF0) extra = 3, min = 0x10000, code = c & 0x07;
+        else return false;
+        if (i + extra >= length) return false;
+        for (size_t k = 1; k <= extra; ++k) {
+            if ((s[i + k] & 0xC0) != 0x80) return false;
+            code = code << 6 | (s[i + k] & 0x3F);
+        }
+        if (code < min || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) return false;
+        i += extra + 1;
+    }
+    return true;
+}
+
+} // namespace Net
+
+#endif // WEBSOCKET_H